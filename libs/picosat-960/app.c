@@ -4,9 +4,21 @@
 #include <string.h>
 #include <ctype.h>
 #include <stdio.h>
+#include <unistd.h>
+
+#ifdef PICOSAT_HAVE_ZLIB
+#include <zlib.h>
+#endif
+#ifdef PICOSAT_HAVE_BZLIB
+#include <bzlib.h>
+#endif
+#ifdef PICOSAT_HAVE_LZMA
+#include <lzma.h>
+#endif
 
 #define GUNZIP "gunzip -c %s"
 #define BUNZIP2 "bzcat %s"
+#define UNXZ "xz -d -c %s"
 #define GZIP "gzip -c -f > %s"
 
 FILE * popen (const char *, const char*);
@@ -15,6 +27,22 @@ int pclose (FILE *);
 static int lineno;
 static FILE *input;
 static int inputid;
+static unsigned char inbuf[1 << 16];
+static unsigned char *inhead = inbuf;
+static unsigned char *intail = inbuf;
+static int input_error;
+#ifdef PICOSAT_HAVE_ZLIB
+static gzFile gzinput;
+#endif
+#ifdef PICOSAT_HAVE_BZLIB
+static BZFILE *bzinput;
+static int bzinput_done;
+#endif
+#ifdef PICOSAT_HAVE_LZMA
+static lzma_stream xzinput = LZMA_STREAM_INIT;
+static int xzinput_open;
+static unsigned char xzbuf[1 << 16];
+#endif
 static FILE *output;
 static int verbose;
 static int sargc;
@@ -28,10 +56,107 @@ static signed char * sol;
 extern void picosat_enter (PicoSAT *);
 extern void picosat_leave (PicoSAT *);
 
+#ifdef PICOSAT_HAVE_LZMA
+static int
+read_xz (void)
+{
+  lzma_ret ret;
+
+  xzinput.next_out = inbuf;
+  xzinput.avail_out = sizeof inbuf;
+
+  while (xzinput.avail_out)
+    {
+      if (!xzinput.avail_in && !feof (input))
+	{
+	  xzinput.next_in = xzbuf;
+	  xzinput.avail_in = fread (xzbuf, 1, sizeof xzbuf, input);
+	  if (ferror (input))
+	    return -1;
+	}
+
+      ret = lzma_code (&xzinput, feof (input) ? LZMA_FINISH : LZMA_RUN);
+      if (ret == LZMA_STREAM_END)
+	break;
+
+      if (ret != LZMA_OK)
+	return -1;
+    }
+
+  return sizeof inbuf - xzinput.avail_out;
+}
+#endif
+
+/* Fill 'inbuf' from the (possibly compressed) input.  Returns the number
+ * of bytes read, '0' at the end of the input and '-1' on errors.
+ */
+static int
+read_input (void)
+{
+  int res;
+#ifdef PICOSAT_HAVE_ZLIB
+  if (gzinput)
+    {
+      int error;
+
+      /* Truncated or corrupted input is only reported by 'gzerror'.
+       */
+      res = gzread (gzinput, inbuf, sizeof inbuf);
+      if (res < 0)
+	return -1;
+
+      (void) gzerror (gzinput, &error);
+
+      return (error == Z_OK) ? res : -1;
+    }
+#endif
+#ifdef PICOSAT_HAVE_BZLIB
+  if (bzinput)
+    {
+      int error;
+
+      if (bzinput_done)
+	return 0;
+
+      res = BZ2_bzRead (&error, bzinput, inbuf, sizeof inbuf);
+      if (error == BZ_STREAM_END)
+	bzinput_done = 1;
+      else if (error != BZ_OK)
+	return -1;
+
+      return res;
+    }
+#endif
+#ifdef PICOSAT_HAVE_LZMA
+  if (xzinput_open)
+    return read_xz ();
+#endif
+  res = fread (inbuf, 1, sizeof inbuf, input);
+
+  return ferror (input) ? -1 : res;
+}
+
 static int
 next (void)
 {
-  int res = getc (input);
+  int res, bytes;
+
+  if (inhead == intail)
+    {
+      bytes = read_input ();
+      if (bytes <= 0)
+	{
+	  if (bytes < 0)
+	    input_error = 1;
+
+	  return EOF;
+	}
+
+      inhead = inbuf;
+      intail = inbuf + bytes;
+    }
+
+  res = *inhead++;
   if (res == '\n')
     lineno++;
 
@@ -60,7 +185,8 @@ SKIP_COMMENTS:
 
   if (ch != 'p')
 INVALID_HEADER:
-    return "missing or invalid 'p cnf <variables> <clauses>' header";
+    return input_error ? "failed to read or decompress input" :
+      "missing or invalid 'p cnf <variables> <clauses>' header";
 
   if (!isspace (next ()))
     goto INVALID_HEADER;
@@ -121,6 +247,9 @@ READ_LITERAL:
 
   if (ch == EOF)
     {
+      if (input_error)
+	return "failed to read or decompress input";
+
       if (lit)
 	return "trailing 0 missing";
 
@@ -252,6 +381,83 @@ has_suffix (const char *str, const char *suffix)
   return str + strlen (str) - strlen (suffix) == tmp;
 }
 
+/* Decompress in process if the library is available.  Returns zero if
+ * 'name' has to be decompressed by an external command.
+ */
+static int
+open_compressed_input (const char *name, FILE ** file_ptr)
+{
+  FILE *file = 0;
+#if defined(PICOSAT_HAVE_BZLIB) || defined(PICOSAT_HAVE_LZMA)
+  int error;
+#endif
+#ifdef PICOSAT_HAVE_ZLIB
+  if (has_suffix (name, ".gz") && (file = fopen (name, "rb")))
+    {
+      int fd = dup (fileno (file));
+
+      if (fd < 0 || !(gzinput = gzdopen (fd, "rb")))
+	{
+	  if (fd >= 0)
+	    close (fd);
+	  fclose (file);
+	  file = 0;
+	}
+    }
+#endif
+#ifdef PICOSAT_HAVE_BZLIB
+  if (has_suffix (name, ".bz2") && (file = fopen (name, "rb")))
+    {
+      bzinput = BZ2_bzReadOpen (&error, file, 0, 0, 0, 0);
+      if (error != BZ_OK)
+	{
+	  if (bzinput)
+	    BZ2_bzReadClose (&error, bzinput);
+	  bzinput = 0;
+	  fclose (file);
+	  file = 0;
+	}
+    }
+#endif
+#ifdef PICOSAT_HAVE_LZMA
+  if (has_suffix (name, ".xz") && (file = fopen (name, "rb")))
+    {
+      error = lzma_stream_decoder (&xzinput, UINT64_MAX, LZMA_CONCATENATED);
+      if (error == LZMA_OK)
+	xzinput_open = 1;
+      else
+	{
+	  fclose (file);
+	  file = 0;
+	}
+    }
+#endif
+  (void) name;
+  *file_ptr = file;
+
+  return file != 0;
+}
+
+static void
+close_compressed_input (void)
+{
+#ifdef PICOSAT_HAVE_ZLIB
+  if (gzinput)
+    gzclose (gzinput);
+#endif
+#ifdef PICOSAT_HAVE_BZLIB
+  if (bzinput)
+    {
+      int error;
+      BZ2_bzReadClose (&error, bzinput);
+    }
+#endif
+#ifdef PICOSAT_HAVE_LZMA
+  if (xzinput_open)
+    lzma_end (&xzinput);
+#endif
+}
+
 static void
 write_core_variables (PicoSAT * picosat, FILE * file)
 {
@@ -756,6 +962,12 @@ picosat_main (PicoSAT ** psptr, int argc, char **argv)
 		   input_name, argv[i]);
 	  err = 1;
 	}
+      else if (open_compressed_input (argv[i], &file))
+	{
+	  input_name = argv[i];
+	  close_input = 1;
+	  input = file;
+	}
       else if (has_suffix (argv[i], ".gz"))
 	{
 	  char *cmd = malloc (strlen (GUNZIP) + strlen (argv[i]));
@@ -794,7 +1006,26 @@ picosat_main (PicoSAT ** psptr, int argc, char **argv)
 	    }
 	  free (cmd);
 	}
-      else if (!(file = fopen (argv[i], "r")))	/* TODO .gz ? */
+      else if (has_suffix (argv[i], ".xz"))
+	{
+	  char *cmd = malloc (strlen (UNXZ) + strlen (argv[i]));
+	  sprintf (cmd, UNXZ, argv[i]);
+	  if ((file = popen (cmd, "r")))
+	    {
+	      input_name = argv[i];
+	      pclose_input = 1;
+	      input = file;
+	    }
+	  else
+	    {
+	      fprintf (output,
+		       "*** picosat: "
+		       "can not read compressed input file '%s'\n", argv[i]);
+	      err = 1;
+	    }
+	  free (cmd);
+	}
+      else if (!(file = fopen (argv[i], "r")))
 	{
 	  fprintf (output,
 		   "*** picosat: can not read input file '%s'\n", argv[i]);
@@ -1035,6 +1266,8 @@ NEXT_SOLUTION:
   if (incremental_rup_file)
     fclose (incremental_rup_file);
 
+  close_compressed_input ();
+
   if (close_input)
     fclose (input);
 
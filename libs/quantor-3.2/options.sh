@@ -1,7 +1,10 @@
 QUANTOR_BACKWARD_PROCESSING=1
 QUANTOR_BACKWARD_SUBSUME=1
+QUANTOR_BCP_BUDGET=100000
 QUANTOR_BINSTRENGTHEN=1
+QUANTOR_BVA=1000000
 QUANTOR_CHECK=0
+QUANTOR_COMPACT=50
 QUANTOR_EQUIVALENCES=1
 QUANTOR_EXISTS=1
 QUANTOR_FORALL=1
@@ -9,23 +12,32 @@ QUANTOR_FORALL_BIAS=1.1
 QUANTOR_FORWARD_PROCESSING=1
 QUANTOR_FORWARD_STRENGTHEN=1
 QUANTOR_FORWARD_SUBSUME=1
+QUANTOR_FORWARD_SUBSUME_DELTA=25
 QUANTOR_FORWARD_SUBSUME_INSTEAD_RECALC=0
 QUANTOR_FUNCTIONS=1
 QUANTOR_FUNCTION_RESOLUTION=0
 QUANTOR_HARD_EXISTS_LIMIT=1000
 QUANTOR_HYPER1RES=1
+QUANTOR_INCREMENTAL=1
+QUANTOR_ITE_XOR=1
 QUANTOR_LITERALS_PER_CLAUSE_FACTOR=1.01
 QUANTOR_LITERALS_PER_CLAUSE_LIMIT=4.0
 QUANTOR_LOG_CLAUSES_OF_SCOPES=0
+QUANTOR_PROBE=100000
+QUANTOR_QBCE=1000000
 QUANTOR_RECALC_SIGS=2
 QUANTOR_RECYCLE_INDICES=1
 QUANTOR_REDUCE_SCOPE=1
 QUANTOR_RESOLVE_EXPORTED=1
+QUANTOR_SCC=10
+QUANTOR_SEARCH=0
 QUANTOR_SIGREF=0
 QUANTOR_SOFT_EXISTS_LENGTH=10
 QUANTOR_SOFT_EXISTS_LIMIT=50
 QUANTOR_SPACE_LIMIT=-1.0
+QUANTOR_STRATEGY=0
 QUANTOR_TIME_LIMIT=-1.0
+QUANTOR_TRACE=0
 QUANTOR_TRIVIAL_FALSITY=0
 QUANTOR_TRIVIAL_TRUTH=0
 QUANTOR_VERBOSE=0
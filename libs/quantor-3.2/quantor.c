@@ -59,10 +59,20 @@ THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 #include <string.h>
 #include <ctype.h>
 #include <sys/time.h>
+#include <time.h>
 #include <unistd.h>
 #ifndef __MINGW32__
 #include <sys/resource.h>
 #endif
+#ifdef QUANTOR_HAVE_ZLIB
+#include <zlib.h>
+#endif
+#ifdef QUANTOR_HAVE_BZLIB
+#include <bzlib.h>
+#endif
+#ifdef QUANTOR_HAVE_LZMA
+#include <lzma.h>
+#endif
 
 /*------------------------------------------------------------------------*/
 
@@ -80,6 +90,27 @@ THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 #define QUANTOR_LOG_MIN_CHUNK_SIZE 16
 #define QUANTOR_MIN_CHUNK_SIZE (1 << QUANTOR_LOG_MIN_CHUNK_SIZE)
 
+/* Objects of at most this many bytes, e.g. clauses with up to about 20
+ * literals, are allocated from per size class free lists.
+ */
+#define QUANTOR_MAX_POOLED_BYTES 1024
+#define QUANTOR_NUM_SIZE_CLASSES \
+  (QUANTOR_MAX_POOLED_BYTES / sizeof (void*) + 1)
+
+/* Clause chunks are not compacted before this many bytes are unused.
+ */
+#define QUANTOR_MIN_COMPACT_BYTES (16 * QUANTOR_MIN_CHUNK_SIZE)
+
+/* Estimated bookkeeping and alignment overhead of 'malloc' per block.
+ */
+#define QUANTOR_MALLOC_OVERHEAD (2 * sizeof (size_t))
+
+/* With a space limit the SAT solver is run in slices, between which the
+ * space limit is checked.  The first slice has this many decisions and
+ * every further slice twice as many as the previous one.
+ */
+#define QUANTOR_SAT_FIRST_SLICE 10000
+
 /*------------------------------------------------------------------------*/
 
 #define QUANTOR_UNDEFINED_SCORE (INT_MAX-0)
@@ -91,8 +122,20 @@ THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 
 /*------------------------------------------------------------------------*/
 
+#define QUANTOR_NUM_STRATEGIES 4	/* see 'strategies' */
+
+/*------------------------------------------------------------------------*/
+
 #define QUANTOR_DEFAULT_SCOPE_NESTING INT_MAX
 
+/*------------------------------------------------------------------------*/
+
+#define QUANTOR_NO_PHASE (-1)
+
+/*------------------------------------------------------------------------*/
+
+#define QUANTOR_PARSE_BUFFER_SIZE (1 << 16)
+
 /*------------------------------------------------------------------------*/
 #ifdef QUANTOR_STATS1
 #define INCSTATS1(s) do { (s) += 1; } while(0)
@@ -112,6 +155,7 @@ extern char **environ;
 /*------------------------------------------------------------------------*/
 
 typedef struct BinDB BinDB;
+typedef struct BinDBEntry BinDBEntry;
 typedef struct Cell Cell;
 typedef struct Clause Clause;
 typedef struct EquivalenceClass EquivalenceClass;
@@ -125,9 +169,12 @@ typedef struct IntStackLitIt IntStackLitIt;
 typedef struct AssignedLitIt AssignedLitIt;
 typedef struct Opts Opts;
 typedef struct Parser Parser;
+typedef struct Progress Progress;
+typedef struct Incremental Incremental;
 typedef struct PtrStack PtrStack;
 typedef struct RHS RHS;
 typedef struct RHSDB RHSDB;
+typedef struct RHSDBEntry RHSDBEntry;
 typedef struct Function Function;
 typedef struct Scope Scope;
 typedef struct Stats Stats;
@@ -247,6 +294,7 @@ struct Var
   int mark;			/* for simplifying clauses */
   int score;			/* rel. est. cost if eliminated */
   int rank;			/* rank in 'order' sorted by 'cost' */
+  int position;			/* order of creation, see 'prefix_score' */
   Scope *scope;
   Lit *lits;			/* positive and negative, actually Lit[2] */
   VarLink unit_link;		/* Quantor.units */
@@ -302,6 +350,7 @@ struct Lit
   unsigned ldsig:6;		/* 0 <= ... < 8*sizeof(Signature) < 64 */
 
   Signature sigsum;		/* either 8, 16, 32, or 64 bits */
+  Signature fresh_sigsum;	/* of fresh clauses, see 'forward_subsume' */
 
 #ifdef QUANTOR_SIGREF
   unsigned char *sigref;
@@ -413,15 +462,16 @@ struct Clause
   unsigned original:1;
   unsigned to_be_mapped:1;
   unsigned part_of_substituted_function:1;
+  unsigned partner:1;		/* of an ITE function, see 'Function' */
+  unsigned fresh:1;		/* added since the last forward subsumption */
   ClauseProcessingType processing_type;
+  int selector;			/* in 'quantor->incremental.solver' */
 
   Signature sig;
 
   ClauseState state;
   Scope *scope;
 
-  Clause *next_in_bindb;
-
   ClauseLink scope_link;
   ClauseLink dying_link;
   ClauseLink marked_link;
@@ -435,10 +485,25 @@ struct Clause
 
 /*------------------------------------------------------------------------*/
 
+/* The binary clauses are stored in an open addressed hash table with
+ * linear probing.  An entry contains the hash value and the sorted
+ * literals of the clause, so that lookups only touch the table.  Removed
+ * entries are kept as tombstones until the next resize.  Empty entries
+ * have a zero 'clause'.
+ */
+struct BinDBEntry
+{
+  unsigned hash;
+  unsigned removed;
+  Lit *a, *b;
+  Clause *clause;
+};
+
 struct BinDB
 {
-  Clause **table;
+  BinDBEntry *table;
   unsigned size, count;
+  unsigned used;		/* including tombstones */
 };
 
 /*------------------------------------------------------------------------*/
@@ -460,9 +525,23 @@ struct EquivalenceClass
 
 /*------------------------------------------------------------------------*/
 
+enum FunctionType
+{
+  QUANTOR_OR_GATE,
+  QUANTOR_ITE_GATE,
+  QUANTOR_XOR_GATE
+};
+
+typedef enum FunctionType FunctionType;
+
+/*------------------------------------------------------------------------*/
+/* The literals of an OR and XOR gate are sorted.  The literals of an ITE
+ * gate are its condition, 'then' and 'else' literal in this order.  Only
+ * functions of the same type can share a RHS.
+ */
 struct RHS
 {
-  RHS *next;			/* collision chain */
+  FunctionType type;
   unsigned size;
   FunctionAnchor functions;
 #ifdef QUANTOR_LOG1
@@ -473,23 +552,23 @@ struct RHS
 
 /*------------------------------------------------------------------------*/
 
-struct RHSDB
+/* Same as 'BinDB'.  The literals of a RHS are only compared if the hash
+ * values match.
+ */
+struct RHSDBEntry
 {
-  RHS **table;
-  unsigned size, count;
+  unsigned hash;
+  unsigned removed;
+  RHS *rhs;
 };
 
-/*------------------------------------------------------------------------*/
-
-enum FunctionType
+struct RHSDB
 {
-  QUANTOR_OR_GATE,
-  QUANTOR_ITE_GATE,
-  QUANTOR_XOR_GATE
+  RHSDBEntry *table;
+  unsigned size, count;
+  unsigned used;		/* including tombstones */
 };
 
-typedef enum FunctionType FunctionType;
-
 /*------------------------------------------------------------------------*/
 
 struct Function
@@ -526,10 +605,18 @@ struct Function
    * base clause for multiple functions, all these functions are linked
    * together.
    *
-   * For XOR functions the 'base clause' is an arbitrary clause.
+   * The base clause of an XOR gate 'x = a ^ b' is one of its four ternary
+   * clauses, which all contain 'x', 'a' and 'b'.  The base clause of an
+   * ITE gate 'x = c ? t : e' contains 'x', 'c' and 't'.  Its 'partner'
+   * clause contains 'x', 'c' and 'e' instead.  Killing the partner clause
+   * also kills the function, so that all variables of the function occur
+   * in the formula as long as the function is alive.  The other clauses
+   * of ITE and XOR gates may be gone, which is checked with
+   * 'find_gate_clauses' before a function is substituted.
    */
   Clause *clause;
   FunctionLink clause_link;	/* Clause.functions */
+  Clause *partner;		/* of ITE gates, otherwise zero */
 
   FunctionLink link;		/* Quantor.functions */
   FunctionLink dying_link;	/* Quantor.dying_functions */
@@ -565,6 +652,37 @@ struct Parser
   unsigned lineno;
   int look_ahead;
   int parsing;
+
+  const unsigned char *pos;	/* next unread character */
+  const unsigned char *end;	/* end of buffered input */
+  unsigned char *buffer;	/* block read from 'io.in' */
+  char err_buffer[80];		/* error with line number */
+};
+
+/*------------------------------------------------------------------------*/
+
+struct Progress
+{
+  QuantorProgressCallback callback;
+  void *state;
+  unsigned interval;
+  unsigned eliminations;
+  unsigned next;		/* report at this number of eliminations */
+};
+
+/*------------------------------------------------------------------------*/
+/* A SAT solver kept between trivial truth checks and the final SAT call,
+ * if the SAT solver back end supports assumptions.  Every clause is added
+ * once to 'solver' with a fresh selector variable as additional literal
+ * and is enabled by assuming the negation of its selector.  Killed clauses
+ * are disabled permanently by adding their selector as unit clause.
+ */
+struct Incremental
+{
+  SatSolver *solver;
+  unsigned added;		/* clauses added to 'solver' */
+  unsigned retired;		/* and disabled again */
+  unsigned rebuilt;		/* number of times 'solver' was rebuilt */
 };
 
 /*------------------------------------------------------------------------*/
@@ -599,16 +717,74 @@ struct Opts
   int resolve_exported;
 
   int equivalences;
+
+  /* BCP stops processing clauses after this many steps per call.  Zero
+   * means no limit.
+   */
+  int bcp_budget;
+
+  /* Merge all literals in strongly connected components of the binary
+   * implication graph as soon as this percentage of the binary clauses is
+   * new since the last decomposition.  Zero disables decomposition.
+   */
+  int scc;
+
   int functions;
   int function_resolution;
 
+  /* Besides OR gates also extract ITE and XOR gates, which are encoded by
+   * four ternary clauses each.
+   */
+  int ite_xor;
+
   int hyper1res;
 
+  /* Failed literal probing of the remaining propositional formula visits
+   * at most this many clauses.  Zero disables probing.
+   */
+  int probe;
+
+  /* Quantified blocked clause elimination before eliminating quantified
+   * variables visits at most this many literals.  Zero disables it.
+   */
+  int qbce;
+
+  /* Bounded variable addition on the innermost existential scope visits
+   * at most this many literals.  Zero disables it.
+   */
+  int bva;
+
   int forall;
   int exists;
+
+  /* Index into 'strategies', which defines the order in which existential
+   * variables of the same scope are eliminated.  With 'trace' enabled, a
+   * line is reported for every eliminated variable and for the result.
+   */
+  int strategy;
+  int trace;
+
+  /* If positive, stop eliminating variables as soon as this percentage of
+   * 'space_limit' is allocated and solve the remaining formula by search.
+   */
+  int search;
+
+  /* Compact the clause store as soon as this percentage of the memory
+   * allocated for clauses is unused.  Zero disables compaction.
+   */
+  int compact;
+
   int trivial_truth;
   int trivial_falsity;
+  int incremental;
   int forward_subsume;
+
+  /* Forward subsumption only checks the clauses added since its last
+   * round, if the occurrences of their literals are at most this
+   * percentage of all literal occurrences.  Otherwise, or if this is zero
+   * or 'backward_subsume' is disabled, all clauses are checked.
+   */
+  int forward_subsume_delta;
   int forward_subsume_instead_recalc;
   int backward_subsume;
   int strengthen;
@@ -715,11 +891,22 @@ struct Stats
   double units;
 #ifdef QUANTOR_STATS2
   unsigned hyper1res_units;
+#endif
+  double failed_literals;
+  double blocked_clauses;
+  double bva_vars;
+  double bva_clauses;		/* removed by bounded variable addition */
+  double hyper_binary_resolvents;
+#ifdef QUANTOR_STATS2
+  double probes;
+  double probe_steps;
 #endif
   double unates;
   double bcps;
 #ifdef QUANTOR_STATS2
   double bcp_rounds;
+  double bcp_steps;
+  double bcp_interrupted;	/* by '--bcp-budget' */
 #endif
 #endif
 
@@ -739,6 +926,8 @@ struct Stats
   double backward_subsumed;
 #ifdef QUANTOR_STATS2
   CacheStats subsume;
+  double forward_subsume_rounds;	/* only checking fresh clauses */
+  double forward_subsume_sweeps;	/* checking all clauses */
 #endif
 #endif
 
@@ -768,6 +957,14 @@ struct Stats
 #endif
 #endif
 
+#ifdef QUANTOR_STATS1
+  CountStats ite;
+  CountStats xor;
+#ifdef QUANTOR_STATS2
+  CacheStats gate_extractions;	/* of ITE and XOR gates */
+#endif
+#endif
+
 #ifdef QUANTOR_STATS2
   double processed;
   double forward_processed;
@@ -823,6 +1020,8 @@ struct Stats
   double equivalences;
 #ifdef QUANTOR_STATS2
   double equivalences_from_functions;
+  double equivalences_from_sccs;
+  double decompositions;
 #endif
 #endif
 #ifdef QUANTOR_STATS2
@@ -832,13 +1031,35 @@ struct Stats
 #endif
 #endif
   size_t bytes, max_bytes;
+
+  /* The space limit is checked against the 'footprint', which in addition
+   * to 'bytes' covers the memory of the SAT solver, if it is allocated
+   * through 'new_sat_solver_memory', and 'QUANTOR_MALLOC_OVERHEAD' for all
+   * 'blocks' allocated by both.
+   */
+  size_t blocks;
+  size_t sat_bytes;
+  size_t max_footprint;
 #ifdef QUANTOR_STATS1
   size_t sat_solver_bytes;
 #endif
 #ifdef QUANTOR_STATS2
   unsigned num_chunks;
+#endif
+#ifdef QUANTOR_STATS1
+  unsigned compactions;
+  double moved_clauses;
+  size_t released_bytes;
 #endif
   double time;
+
+  /* The phase timers are always compiled in.  Only the currently active
+   * phase is running (see 'enter_phase' and 'leave_phase').
+   */
+  int phase;
+  double phase_entered;
+  double phase_seconds[QUANTOR_NUM_PHASES];
+  double phase_count[QUANTOR_NUM_PHASES];
 #ifdef QUANTOR_STATS1
   double sat_solver_time;
 #ifdef QUANTOR_STATS2
@@ -859,6 +1080,20 @@ struct IO
   int pclose_in;
   const char *in_name;
 
+  /* Decompressors reading the compressed file 'in'.
+   */
+#ifdef QUANTOR_HAVE_ZLIB
+  gzFile gzin;
+#endif
+#ifdef QUANTOR_HAVE_BZLIB
+  BZFILE *bzin;
+  int bzin_done;
+#endif
+#ifdef QUANTOR_HAVE_LZMA
+  lzma_stream *xzin;
+  unsigned char *xzin_buffer;
+#endif
+
   FILE *out;
   const char *out_name;
   int close_out;
@@ -873,6 +1108,7 @@ struct Quantor
 
   PtrStack vars;
   IntStack free_var_indices;
+  int positions;		/* number of created variables */
   int no_more_external_vars;
   VarAnchor units;
   VarAnchor unates;
@@ -894,20 +1130,25 @@ struct Quantor
   int invalid;
   IntStack free_clause_indices;
   PtrStack new_clause;
+  PtrStack occurrences;		/* scratch copy of a column */
+  PtrStack fresh_lits;		/* with non zero 'fresh_sigsum' */
   ClauseAnchor dying_clauses;
   ClauseAnchor marked_clauses;
   IntStack dead_original_clauses;
   int save_dead_original_clauses;
+
   int original_problem_is_propositional;
   ClauseAnchor unprocessed_clauses;
   LitAnchor unprocessed_literals;
 
   BinDB *bindb;
+  unsigned new_binary_clauses;	/* since last 'decompose' */
 
   RHSDB *rhsdb;
   PtrStack new_rhs;
   FunctionAnchor functions;
   FunctionAnchor dying_functions;
+  unsigned ite_xor_gates;	/* extracted so far */
 
   SatSolverAPI *sat_api;
 
@@ -920,11 +1161,24 @@ struct Quantor
   InternalQuantificationType external_type;
   Parser parser;
   IntStack external_assignment;
+  IntStack external_prefix;
+  Progress progress;
+  Incremental incremental;
 
   Lit *free_literal_pairs;
   Var *free_vars;
 #ifdef QUANTOR_FAST_ALLOC
   Chunk *allocated_chunks;
+  void *free_lists[QUANTOR_NUM_SIZE_CLASSES];
+
+  /* Clauses have their own chunks, so that sparsely used chunks can be
+   * evacuated and released by 'compact_clauses'.
+   */
+  Chunk *clause_chunks;
+  void *free_clauses[QUANTOR_NUM_SIZE_CLASSES];
+  size_t clause_chunk_bytes;	/* in 'clause_chunks' */
+  size_t clause_bytes;		/* used by live clauses in 'clause_chunks' */
+  size_t compact_limit;		/* minimum free bytes for compaction */
 #endif
   char *prefix;
 
@@ -956,6 +1210,7 @@ struct SatSolverAPI
   int (*add) (SatSolver *, int);
     QuantorResult (*run) (SatSolver *);
   void (*assignment) (SatSolver *);
+  void (*assume) (SatSolver *, int);	/* zero if not incremental */
 };
 
 /*------------------------------------------------------------------------*/
@@ -1038,6 +1293,89 @@ get_time (void)
   return res;
 }
 
+/*------------------------------------------------------------------------*/
+/* In contrast to 'get_time' this is wall clock time, which on most
+ * platforms can be obtained without a system call.  It is cheap enough to
+ * be used for timing even very frequent phases such as BCP.
+ */
+static double
+get_monotonic_time (void)
+{
+#if defined(CLOCK_MONOTONIC) && !defined(__MINGW32__)
+  struct timespec ts;
+#endif
+  struct timeval tv;
+  double res;
+
+  res = 0;
+#if defined(CLOCK_MONOTONIC) && !defined(__MINGW32__)
+  if (!clock_gettime (CLOCK_MONOTONIC, &ts))
+    res = ts.tv_sec + 1e-9 * ts.tv_nsec;
+  else
+#endif
+  if (!gettimeofday (&tv, 0))
+    res = tv.tv_sec + 1e-6 * tv.tv_usec;
+
+  return res;
+}
+
+/*------------------------------------------------------------------------*/
+
+static void
+stop_phase_timer (Quantor * quantor, double now)
+{
+  Stats *stats = &quantor->stats;
+  double delta;
+
+  if (stats->phase == QUANTOR_NO_PHASE)
+    return;
+
+  delta = now - stats->phase_entered;
+  if (delta > 0)
+    stats->phase_seconds[stats->phase] += delta;
+}
+
+/*------------------------------------------------------------------------*/
+/* Switch to a new phase and return the previous one, which has to be
+ * passed to the matching 'leave_phase'.
+ */
+static int
+enter_phase (Quantor * quantor, QuantorPhase phase)
+{
+  Stats *stats = &quantor->stats;
+  double now;
+  int res;
+
+  assert (0 <= phase && phase < QUANTOR_NUM_PHASES);
+
+  now = get_monotonic_time ();
+  stop_phase_timer (quantor, now);
+
+  res = stats->phase;
+  stats->phase = phase;
+  stats->phase_entered = now;
+  stats->phase_count[phase] += 1;
+
+  return res;
+}
+
+/*------------------------------------------------------------------------*/
+
+static void
+leave_phase (Quantor * quantor, int prev_phase)
+{
+  Stats *stats = &quantor->stats;
+  double now;
+
+  assert (stats->phase != QUANTOR_NO_PHASE);
+
+  now = get_monotonic_time ();
+  stop_phase_timer (quantor, now);
+
+  stats->phase = prev_phase;
+  stats->phase_entered = now;
+}
+
 /*------------------------------------------------------------------------*/
 #ifdef QUANTOR_STATS1
 /*------------------------------------------------------------------------*/
@@ -1065,6 +1403,45 @@ dec_count_stats (CountStats * stats)
 #endif
 /*------------------------------------------------------------------------*/
 
+static size_t
+footprint (Quantor * quantor)
+{
+  Stats *stats = &quantor->stats;
+  return stats->bytes + stats->sat_bytes +
+    stats->blocks * QUANTOR_MALLOC_OVERHEAD;
+}
+
+/*------------------------------------------------------------------------*/
+
+static void
+update_max_footprint (Quantor * quantor)
+{
+  size_t bytes = footprint (quantor);
+  if (bytes > quantor->stats.max_footprint)
+    quantor->stats.max_footprint = bytes;
+}
+
+/*------------------------------------------------------------------------*/
+/* Peak resident set size of the process in bytes, or zero if unknown.
+ */
+static size_t
+get_max_rss (void)
+{
+#ifndef __MINGW32__
+  struct rusage u;
+
+  if (!getrusage (RUSAGE_SELF, &u))
+#ifdef __APPLE__
+    return u.ru_maxrss;
+#else
+    return ((size_t) u.ru_maxrss) << 10;
+#endif
+#endif
+  return 0;
+}
+
+/*------------------------------------------------------------------------*/
+
 static void *
 new (Quantor * quantor, size_t size)
 {
@@ -1082,11 +1459,14 @@ new (Quantor * quantor, size_t size)
   *res++ = size;
 #endif
   quantor->stats.bytes += size;
+  quantor->stats.blocks++;
   memset (res, 0, size);
 
   if (quantor->stats.bytes > quantor->stats.max_bytes)
     quantor->stats.max_bytes = quantor->stats.bytes;
 
+  update_max_footprint (quantor);
+
   return res;
 }
 
@@ -1110,6 +1490,8 @@ delete (Quantor * quantor, void *ptr, size_t size)
 #endif
       assert (quantor->stats.bytes >= size);
       quantor->stats.bytes -= size;
+      assert (quantor->stats.blocks > 0);
+      quantor->stats.blocks--;
 #ifndef NDEBUG
       memset (real_ptr, 0, real_size);
 #endif
@@ -1709,6 +2091,63 @@ dlink_if_not_linked (void *anchor, void *this, void *link)
   return res;
 }
 
+/*------------------------------------------------------------------------*/
+#ifdef QUANTOR_FAST_ALLOC
+/*------------------------------------------------------------------------*/
+/* After an object has been copied from 'old' to 'this' let its neighbours
+ * and the anchor point to the copy.  Objects which are not linked are left
+ * untouched.
+ */
+static void
+move_dlink (void *anchor_as_void_ptr, void *old_as_void_ptr,
+	    void *this_as_void_ptr, void *this_link_as_void_ptr)
+{
+  GenericLink *this_link, *prev_link, *next_link;
+  void **prev, **this, **next;
+  GenericAnchor *anchor;
+  unsigned offset;
+
+  anchor = anchor_as_void_ptr;
+
+  this = this_as_void_ptr;
+  this_link = this_link_as_void_ptr;
+
+  offset = ((void **) this_link) - this;
+
+  prev = this_link->prev;
+  next = this_link->next;
+
+  if (prev)
+    {
+      prev_link = (GenericLink *) (prev + offset);
+      assert (prev_link->next == old_as_void_ptr);
+      prev_link->next = this;
+    }
+  else if (anchor->first == old_as_void_ptr)
+    anchor->first = this;
+  else
+    {
+      assert (!next);
+      return;
+    }
+
+  if (next)
+    {
+      next_link = (GenericLink *) (next + offset);
+      assert (next_link->prev == old_as_void_ptr);
+      next_link->prev = this;
+    }
+  else
+    {
+      assert (anchor->last == old_as_void_ptr);
+      anchor->last = this;
+    }
+}
+
+/*------------------------------------------------------------------------*/
+#endif
+/*------------------------------------------------------------------------*/
+
 /*------------------------------------------------------------------------*/
 
 static const char *
@@ -1900,8 +2339,9 @@ new_BinDB (Quantor * quantor)
   size_t bytes;
 
   res = new (quantor, sizeof (*res));
-  res->size = (1 << 10);
+  res->size = (1 << 8);
   res->count = 0;
+  res->used = 0;
   bytes = res->size * sizeof (res->table[0]);
   res->table = new (quantor, bytes);
 
@@ -1929,8 +2369,9 @@ new_RHSDB (Quantor * quantor)
   RHSDB *res;
 
   res = new (quantor, sizeof (*res));
-  res->size = 1;
+  res->size = (1 << 4);
   res->count = 0;
+  res->used = 0;
   bytes = res->size * sizeof (res->table[0]);
   res->table = new (quantor, bytes);
 
@@ -2016,6 +2457,11 @@ log_rhs (Quantor * quantor, RHS * rhs)
 
 /*------------------------------------------------------------------------*/
 
+static void *new_pooled (Quantor *, size_t);
+static void delete_pooled (Quantor *, void *, size_t);
+
+/*------------------------------------------------------------------------*/
+
 static size_t
 sizeof_RHS (int size)
 {
@@ -2089,14 +2535,16 @@ push_new_rhs (Quantor * quantor, Clause * clause, Lit * lhs)
 /*------------------------------------------------------------------------*/
 
 static RHS *
-new_RHS (Quantor * quantor, Lit ** literals, unsigned size)
+new_RHS (Quantor * quantor,
+	 FunctionType type, Lit ** literals, unsigned size)
 {
   Lit **src, **dst, **end_of_src;
   size_t bytes;
   RHS *res;
 
   bytes = sizeof_RHS (size);
-  res = new (quantor, bytes);
+  res = new_pooled (quantor, bytes);
+  res->type = type;
   res->size = size;
 
   end_of_src = literals + size;
@@ -2168,15 +2616,17 @@ extend_literal_hash_value (Quantor * quantor, unsigned hash, Lit * lit)
 /*------------------------------------------------------------------------*/
 
 static unsigned
-hash_literals (Quantor * quantor, Lit ** literals, unsigned size)
+hash_literals (Quantor * quantor,
+	       FunctionType type, Lit ** literals, unsigned size)
 {
   Lit **p, **end_of_literals;
   unsigned res;
 
-  check_that_literals_are_sorted (literals, size);
+  if (type != QUANTOR_ITE_GATE)
+    check_that_literals_are_sorted (literals, size);
 
   end_of_literals = literals + size;
-  res = 0;
+  res = (unsigned) type;
 
   for (p = literals; p < end_of_literals; p++)
     res = extend_literal_hash_value (quantor, res, *p);
@@ -2187,13 +2637,17 @@ hash_literals (Quantor * quantor, Lit ** literals, unsigned size)
 /*------------------------------------------------------------------------*/
 
 static int
-literals_match_rhs (Lit ** literals, unsigned size, RHS * rhs)
+literals_match_rhs (FunctionType type,
+		    Lit ** literals, unsigned size, RHS * rhs)
 {
   Lit **p, **q, **end_of_literals;
 
   if (size != rhs->size)
     return 0;
 
+  if (type != rhs->type)
+    return 0;
+
   p = literals;
   q = rhs->literals;
   end_of_literals = literals + size;
@@ -2205,41 +2659,56 @@ literals_match_rhs (Lit ** literals, unsigned size, RHS * rhs)
   return 1;
 }
 
+/*------------------------------------------------------------------------*/
+/* Start of the probe sequence for 'hash' in a table with 'size' entries.
+ * The upper half is folded in, since the lower bits of the hash value of a
+ * sequence of literals only depend on its last literals.
+ */
+static unsigned
+hash2pos (unsigned hash, unsigned size)
+{
+  assert (size && !(size & (size - 1)));
+  return (hash ^ (hash >> 16)) & (size - 1);
+}
+
 /*------------------------------------------------------------------------*/
 
-static RHS **
-find_RHS (Quantor * quantor, Lit ** literals, unsigned size)
+static RHS *
+find_RHS (Quantor * quantor,
+	  FunctionType type, Lit ** literals, unsigned size)
 {
-  RHS **p, *rhs;
-  unsigned h;
+  RHSDBEntry *e;
+  RHSDB *rhsdb;
+  unsigned h, i;
 
   assert (quantor->opts.functions);
 
-  h = hash_literals (quantor, literals, size);
-  h &= quantor->rhsdb->size - 1;
-  assert (h < quantor->rhsdb->size);
+  rhsdb = quantor->rhsdb;
+  h = hash_literals (quantor, type, literals, size);
 
-  for (p = quantor->rhsdb->table + h;
-       (rhs = *p) && !literals_match_rhs (literals, size, rhs);
-       p = &(*p)->next)
-    ;
+  for (i = hash2pos (h, rhsdb->size);
+       (e = rhsdb->table + i)->rhs || e->removed;
+       i = (i + 1) & (rhsdb->size - 1))
+    if (e->rhs && e->hash == h &&
+	literals_match_rhs (type, literals, size, e->rhs))
+      return e->rhs;
 
-  return p;
+  return 0;
 }
 
 /*------------------------------------------------------------------------*/
 
 static int
-contains_RHS (Quantor * quantor,
+contains_RHS (Quantor * quantor, FunctionType type,
 	      Lit ** literals, unsigned size, RHS ** res_ptr)
 {
-  RHS **p;
+  RHS *rhs;
 
-  p = find_RHS (quantor, literals, size);
-  if (*p)
+  rhs = find_RHS (quantor, type, literals, size);
+  if (rhs)
     {
       if (res_ptr)
-	*res_ptr = *p;
+	*res_ptr = rhs;
 
       return 1;
     }
@@ -2249,20 +2718,12 @@ contains_RHS (Quantor * quantor,
 
 /*------------------------------------------------------------------------*/
 
-static int
-is_full_RHSDB (Quantor * quantor)
-{
-  return quantor->rhsdb->count >= quantor->rhsdb->size;
-}
-
-/*------------------------------------------------------------------------*/
-
 static unsigned
 hash_RHS (Quantor * quantor, RHS * rhs)
 {
   unsigned res, i;
 
-  res = 0;
+  res = (unsigned) rhs->type;
   for (i = 0; i < rhs->size; i++)
     res = extend_literal_hash_value (quantor, res, rhs->literals[i]);
 
@@ -2274,9 +2735,10 @@ hash_RHS (Quantor * quantor, RHS * rhs)
 static void
 delete_RHS (Quantor * quantor, RHS * rhs, int finally)
 {
+  RHSDBEntry *e;
+  RHSDB *rhsdb;
   size_t bytes;
-  unsigned h;
-  RHS **p;
+  unsigned i;
 
   assert (!rhs->functions.first);
 
@@ -2287,51 +2749,55 @@ delete_RHS (Quantor * quantor, RHS * rhs, int finally)
   (void) finally;
 #endif
 
-  h = hash_RHS (quantor, rhs);
-  h &= quantor->rhsdb->size - 1;
-  assert (h < quantor->rhsdb->size);
-
-  for (p = quantor->rhsdb->table + h; *p && *p != rhs; p = &(*p)->next)
-    ;
+  rhsdb = quantor->rhsdb;
+  i = hash2pos (hash_RHS (quantor, rhs), rhsdb->size);
+  while ((e = rhsdb->table + i)->rhs != rhs)
+    {
+      assert (e->rhs || e->removed);
+      i = (i + 1) & (rhsdb->size - 1);
+    }
 
-  assert (*p == rhs);
-  *p = rhs->next;
+  e->rhs = 0;
+  e->removed = 1;
 
-  assert (quantor->rhsdb->count > 0);
-  quantor->rhsdb->count--;
+  assert (rhsdb->count > 0);
+  rhsdb->count--;
 
   bytes = sizeof_RHS (rhs->size);
-  delete (quantor, rhs, bytes);
+  delete_pooled (quantor, rhs, bytes);
 }
 
 /*------------------------------------------------------------------------*/
-
+/* Rehash the remaining entries by their stored hash values, which drops
+ * the tombstones.  The size is doubled unless most entries are tombstones.
+ */
 static void
-enlarge_RHSDB (Quantor * quantor)
+resize_RHSDB (Quantor * quantor, RHSDB * rhsdb)
 {
-  RHS **old_table, **new_table, *p, *next;
-  unsigned old_size, new_size, i, h;
+  RHSDBEntry *old_table, *p, *q;
+  unsigned old_size, i;
   size_t bytes;
 
-  old_table = quantor->rhsdb->table;
-  old_size = quantor->rhsdb->size;
-  new_size = old_size * 2;
-  quantor->rhsdb->size = new_size;
-  bytes = new_size * sizeof (new_table[0]);
-  new_table = new (quantor, bytes);
-  quantor->rhsdb->table = new_table;
+  old_table = rhsdb->table;
+  old_size = rhsdb->size;
+
+  if (4 * (rhsdb->count + 1) > old_size)
+    rhsdb->size *= 2;
 
-  for (i = 0; i < old_size; i++)
+  bytes = rhsdb->size * sizeof (rhsdb->table[0]);
+  rhsdb->table = new (quantor, bytes);
+  rhsdb->used = rhsdb->count;
+
+  for (p = old_table; p < old_table + old_size; p++)
     {
-      for (p = old_table[i]; p; p = next)
-	{
-	  next = p->next;
-	  h = hash_RHS (quantor, p);
-	  h &= new_size - 1;
-	  assert (h < new_size);
-	  p->next = new_table[h];
-	  new_table[h] = p;
-	}
+      if (!p->rhs)
+	continue;
+
+      for (i = hash2pos (p->hash, rhsdb->size);
+	   (q = rhsdb->table + i)->rhs; i = (i + 1) & (rhsdb->size - 1))
+	;
+
+      *q = *p;
     }
 
   bytes = old_size * sizeof (old_table[0]);
@@ -2341,29 +2807,41 @@ enlarge_RHSDB (Quantor * quantor)
 /*------------------------------------------------------------------------*/
 
 static RHS *
-insert_RHS (Quantor * quantor, Lit ** literals, unsigned size)
+insert_RHS (Quantor * quantor,
+	    FunctionType type, Lit ** literals, unsigned size)
 {
-  RHS **p, *res;
+  RHSDBEntry *e;
+  RHSDB *rhsdb;
+  unsigned h, i;
+  RHS *res;
 
   assert (quantor->opts.functions);
+  assert (!find_RHS (quantor, type, literals, size));
 
-  if (is_full_RHSDB (quantor))
-    enlarge_RHSDB (quantor);
+  rhsdb = quantor->rhsdb;
+  if (2 * (rhsdb->used + 1) > rhsdb->size)
+    resize_RHSDB (quantor, rhsdb);
 
-  p = find_RHS (quantor, literals, size);
-  assert (!*p);
+  h = hash_literals (quantor, type, literals, size);
+  for (i = hash2pos (h, rhsdb->size);
+       (e = rhsdb->table + i)->rhs; i = (i + 1) & (rhsdb->size - 1))
+    ;
 
-  res = new_RHS (quantor, literals, size);
+  res = new_RHS (quantor, type, literals, size);
 #ifdef QUANTOR_CHECK
   if (quantor->opts.check)
     {
-      assert (hash_RHS (quantor, res) ==
-	      hash_literals (quantor, literals, size));
-      assert (literals_match_rhs (literals, size, res));
+      assert (hash_RHS (quantor, res) == h);
+      assert (literals_match_rhs (type, literals, size, res));
     }
 #endif
-  *p = res;
-  quantor->rhsdb->count++;
+  if (!e->removed)
+    rhsdb->used++;
+
+  e->hash = h;
+  e->removed = 0;
+  e->rhs = res;
+  rhsdb->count++;
 
   return res;
 }
@@ -2385,6 +2863,7 @@ new_Quantor (void)
   res->io.out_name = "<stdout>";
 
   res->stats.time = get_time ();
+  res->stats.phase = QUANTOR_NO_PHASE;
   res->recalc_sigs_count_down = 100;
   res->max_external_nesting = -1;
 
@@ -2398,6 +2877,7 @@ quantor_setup (Quantor * quantor)
 {
   if (!quantor->opts.equivalences)
     {
+      quantor->opts.scc = 0;
       quantor->opts.functions = 0;
       quantor->opts.hyper1res = 0;
       quantor->opts.binstrengthen = 0;
@@ -2418,6 +2898,9 @@ quantor_setup (Quantor * quantor)
       quantor->opts.hyper1res = 0;
     }
 
+  if (!quantor->opts.functions)
+    quantor->opts.ite_xor = 0;
+
   if (!quantor->opts.functions && !quantor->opts.hyper1res)
     {
       quantor->opts.forward_processing = 0;
@@ -2430,6 +2913,10 @@ quantor_setup (Quantor * quantor)
   if (quantor->opts.functions)
     quantor->rhsdb = new_RHSDB (quantor);
 
+  if (quantor->opts.strategy < 0 ||
+      quantor->opts.strategy >= QUANTOR_NUM_STRATEGIES)
+    quantor->opts.strategy = 0;
+
   if (quantor->opts.soft_exists_length < 0)
     quantor->opts.soft_exists_length = 0;
 
@@ -2443,17 +2930,26 @@ quantor_setup (Quantor * quantor)
 /*------------------------------------------------------------------------*/
 
 static void
-release_chunks (Quantor * quantor)
+release_chunk_list (Quantor * quantor, Chunk * chunks)
 {
   Chunk *p, *next;
 
-  for (p = quantor->allocated_chunks; p; p = next)
+  for (p = chunks; p; p = next)
     {
       next = p->header.next;
       delete (quantor, p, p->header.bytes + CHUNK_DATA_OFFSET);
     }
 }
 
+/*------------------------------------------------------------------------*/
+
+static void
+release_chunks (Quantor * quantor)
+{
+  release_chunk_list (quantor, quantor->allocated_chunks);
+  release_chunk_list (quantor, quantor->clause_chunks);
+}
+
 /*------------------------------------------------------------------------*/
 #endif
 /*------------------------------------------------------------------------*/
@@ -2517,7 +3013,7 @@ align (void *ptr, size_t size)
 /*------------------------------------------------------------------------*/
 
 static void
-populate_aux (Quantor * quantor, void *anchor_as_void_ptr,
+populate_aux (Quantor * quantor, Chunk ** chunks, void *anchor_as_void_ptr,
 	      int min_nelems, size_t size, size_t alignment)
 {
   int aligned_start_idx, count, nelems;
@@ -2540,9 +3036,9 @@ populate_aux (Quantor * quantor, void *anchor_as_void_ptr,
   assert (bytes >= QUANTOR_MIN_CHUNK_SIZE);
   chunk = new (quantor, bytes + CHUNK_DATA_OFFSET);
   chunk->header.bytes = bytes;
-  chunk->header.next = quantor->allocated_chunks;
+  chunk->header.next = *chunks;
   chunk->header.size = size;
-  quantor->allocated_chunks = chunk;
+  *chunks = chunk;
 
   if (alignment)
     {
@@ -2579,7 +3075,8 @@ populate_aux (Quantor * quantor, void *anchor_as_void_ptr,
 static void
 populate (Quantor * quantor, void *anchor_as_void_ptr, size_t sz)
 {
-  populate_aux (quantor, anchor_as_void_ptr, 1000, sz, 0);
+  populate_aux (quantor, &quantor->allocated_chunks,
+		anchor_as_void_ptr, 1000, sz, 0);
 }
 
 /*------------------------------------------------------------------------*/
@@ -2587,7 +3084,8 @@ populate (Quantor * quantor, void *anchor_as_void_ptr, size_t sz)
 static void
 populate_aligned (Quantor * quantor, void *anchor_as_void_ptr, size_t sz)
 {
-  populate_aux (quantor, anchor_as_void_ptr, 1000, sz, sz);
+  populate_aux (quantor, &quantor->allocated_chunks,
+		anchor_as_void_ptr, 1000, sz, sz);
 }
 
 /*------------------------------------------------------------------------*/
@@ -2608,6 +3106,109 @@ put_back_on_free_list (Quantor * quantor,
 
 /*------------------------------------------------------------------------*/
 #endif /* QUANTOR_FAST_ALLOC */
+/*------------------------------------------------------------------------*/
+/* Variable sized objects which are allocated and released at a high rate,
+ * in particular clauses during 'exists' and 'forall', are taken from free
+ * lists, one for each size rounded up to a multiple of the pointer size.
+ * The free lists are populated chunk wise and are only released as a
+ * whole by 'release_chunks'.
+ */
+static void *
+new_pooled (Quantor * quantor, size_t bytes)
+{
+#ifdef QUANTOR_FAST_ALLOC
+  unsigned size_class;
+  void **anchor, *res;
+
+  if (bytes <= QUANTOR_MAX_POOLED_BYTES)
+    {
+      size_class = (bytes + sizeof (void *) - 1) / sizeof (void *);
+      anchor = quantor->free_lists + size_class;
+      if (!*anchor)
+	populate_aux (quantor, &quantor->allocated_chunks,
+		      anchor, 1, size_class * sizeof (void *), 0);
+
+      res = *anchor;
+      *anchor = *(void **) res;
+      memset (res, 0, bytes);
+
+      return res;
+    }
+#endif
+  return new (quantor, bytes);
+}
+
+/*------------------------------------------------------------------------*/
+
+static void
+delete_pooled (Quantor * quantor, void *ptr, size_t bytes)
+{
+#ifdef QUANTOR_FAST_ALLOC
+  unsigned size_class;
+
+  if (bytes <= QUANTOR_MAX_POOLED_BYTES)
+    {
+      size_class = (bytes + sizeof (void *) - 1) / sizeof (void *);
+      put_back_on_free_list (quantor, quantor->free_lists + size_class, ptr);
+      return;
+    }
+#endif
+  delete (quantor, ptr, bytes);
+}
+
+/*------------------------------------------------------------------------*/
+/* Same as 'new_pooled' and 'delete_pooled' but for clauses, which are
+ * taken from 'clause_chunks', so that they can be compacted.
+ */
+static void *
+new_clause_memory (Quantor * quantor, size_t bytes)
+{
+#ifdef QUANTOR_FAST_ALLOC
+  unsigned size_class;
+  void **anchor, *res;
+
+  if (bytes <= QUANTOR_MAX_POOLED_BYTES)
+    {
+      size_class = (bytes + sizeof (void *) - 1) / sizeof (void *);
+      anchor = quantor->free_clauses + size_class;
+      if (!*anchor)
+	{
+	  populate_aux (quantor, &quantor->clause_chunks,
+			anchor, 1, size_class * sizeof (void *), 0);
+	  quantor->clause_chunk_bytes += quantor->clause_chunks->header.bytes;
+	}
+
+      res = *anchor;
+      *anchor = *(void **) res;
+      memset (res, 0, bytes);
+      quantor->clause_bytes += size_class * sizeof (void *);
+
+      return res;
+    }
+#endif
+  return new (quantor, bytes);
+}
+
+/*------------------------------------------------------------------------*/
+
+static void
+delete_clause_memory (Quantor * quantor, void *ptr, size_t bytes)
+{
+#ifdef QUANTOR_FAST_ALLOC
+  unsigned size_class;
+
+  if (bytes <= QUANTOR_MAX_POOLED_BYTES)
+    {
+      size_class = (bytes + sizeof (void *) - 1) / sizeof (void *);
+      put_back_on_free_list (quantor, quantor->free_clauses + size_class, ptr);
+      assert (quantor->clause_bytes >= size_class * sizeof (void *));
+      quantor->clause_bytes -= size_class * sizeof (void *);
+      return;
+    }
+#endif
+  delete (quantor, ptr, bytes);
+}
+
 /*------------------------------------------------------------------------*/
 
 static void
@@ -3606,6 +4207,7 @@ new_Var (Quantor * quantor, int idx, Scope * scope)
   res = new (quantor, sizeof (*res));
 #endif
   res->idx = idx;
+  res->position = quantor->positions++;
   res->lits = new_literal_pair (quantor, res);
 #ifdef QUANTOR_STATS1
   inc_count_stats (&quantor->stats.vars);
@@ -4184,6 +4786,12 @@ delete_Function (Quantor * quantor, Function * function, int finally)
   type_stats = 0;
   switch (function->type)
     {
+    case QUANTOR_ITE_GATE:
+      type_stats = &quantor->stats.ite;
+      break;
+    case QUANTOR_XOR_GATE:
+      type_stats = &quantor->stats.xor;
+      break;
     default:
       assert (function->type == QUANTOR_OR_GATE);
       type_stats = &quantor->stats.or;
@@ -4207,7 +4815,7 @@ delete_Function (Quantor * quantor, Function * function, int finally)
   undlink (&function->clause->functions, function, &function->clause_link);
 
   undlink (&quantor->functions, function, &function->link);
-  delete (quantor, function, sizeof (*function));
+  delete_pooled (quantor, function, sizeof (*function));
 }
 
 /*------------------------------------------------------------------------*/
@@ -4224,7 +4832,14 @@ register_invalidity (Quantor * quantor)
 }
 
 /*------------------------------------------------------------------------*/
-
+/* Scores are updated lazily.  Adding or removing a cell only enqueues its
+ * variable on the 'reorder' list of its scope, and 'reorder_scope' rescores
+ * the enqueued variables when 'pivot' needs the cheapest variable of that
+ * scope.  Since 'exists_resolve_all_score' and 'forall_score' only use the
+ * occurrence counts 'column.len' and literal sums 'sum', which are kept up
+ * to date incrementally, rescoring a variable takes constant time (apart
+ * from function resolution, which iterates the functions of the variable).
+ */
 static void
 mark_to_be_reordered (Quantor * quantor, Var * v)
 {
@@ -5219,8 +5834,6 @@ sub_sig (Quantor * quantor, Lit * lit, Signature sig)
 /*------------------------------------------------------------------------*/
 #endif
 /*------------------------------------------------------------------------*/
-#ifndef NDEBUG
-/*------------------------------------------------------------------------*/
 
 static int
 is_dying_Function (Quantor * quantor, Function * function)
@@ -5229,8 +5842,6 @@ is_dying_Function (Quantor * quantor, Function * function)
 		    function, &function->dying_link);
 }
 
-/*------------------------------------------------------------------------*/
-#endif
 /*------------------------------------------------------------------------*/
 
 static int
@@ -5296,6 +5907,39 @@ kill_Function (Quantor * quantor, Function * function)
 #endif
 }
 
+/*------------------------------------------------------------------------*/
+/* Partner clauses of ITE functions are not linked to their functions.  The
+ * functions are found through the LHS variable instead, which occurs in the
+ * partner clause.
+ */
+static void
+kill_functions_of_partner (Quantor * quantor, Clause * clause)
+{
+  Cell *c, *eor;
+  Function *f;
+
+  eor = end_of_row (clause);
+  for (c = clause->row; c < eor; c++)
+    for (f = c->lit->var->functions.first; f; f = f->lhs_link.next)
+      if (f->partner == clause && !is_dying_Function (quantor, f))
+	kill_Function (quantor, f);
+}
+
+/*------------------------------------------------------------------------*/
+
+static void
+retire_incremental_clause (Quantor * quantor, Clause * clause)
+{
+  SatSolver *solver = quantor->incremental.solver;
+
+  assert (solver);
+  assert (clause->selector > 0);
+
+  solver->api->add (solver, clause->selector);
+  solver->api->add (solver, 0);
+  quantor->incremental.retired++;
+}
+
 /*------------------------------------------------------------------------*/
 
 static void
@@ -5330,11 +5974,18 @@ kill_Clause (Quantor * quantor, Clause * clause)
   dlink (&quantor->dying_clauses, clause, &clause->dying_link);
   clause->state = QUANTOR_DYING_CLAUSE;
 
+  if (clause->selector)
+    retire_incremental_clause (quantor, clause);
+
   if (is_unprocessed_clause (quantor, clause))
     remove_unprocessed_clauses (quantor, clause);
 
   for (f = clause->functions.first; f; f = f->clause_link.next)
-    kill_Function (quantor, f);
+    if (!is_dying_Function (quantor, f))
+      kill_Function (quantor, f);
+
+  if (clause->partner)
+    kill_functions_of_partner (quantor, clause);
 
   if (clause->size == 2)
     {
@@ -5621,7 +6272,7 @@ alloc_Clause (Quantor * quantor, int size)
   Clause *res;
 
   assert (size >= 0);
-  res = new (quantor, sizeof_Clause (size));
+  res = new_clause_memory (quantor, sizeof_Clause (size));
   res->size = size;
 
 #ifdef QUANTOR_STATS1
@@ -5778,60 +6429,42 @@ hash_Clause (Quantor * quantor, Clause * clause)
 
 /*------------------------------------------------------------------------*/
 
-static int
-eq_Clause (Quantor * quantor, Clause * a, Clause * b)
+static unsigned
+hash_binary_clause (Quantor * quantor, Lit * a, Lit * b)
 {
-  Cell *p, *q, *aeor, *beor;
-  Lit *al, *bl;
-  int res;
-
-  (void) quantor;
-  (void) beor;
-  res = 0;
-
-  if (a->size == b->size)
-    {
-      res = 1;
-      p = a->row;
-      q = b->row;
-      aeor = end_of_row (a);
-      beor = end_of_row (b);
+  unsigned res;
 
-      while (res && p < aeor)
-	{
-	  assert (q < beor);
-	  al = p++->lit;
-	  bl = q++->lit;
-	  res = (al == bl);
-	}
+  assert (cmp_lit (a, b) < 0);
 
-      assert (!res || q == beor);
-    }
+  res = extend_literal_hash_value (quantor, 0, a);
+  assert (res == hash_lit (quantor, a));
+  res = extend_literal_hash_value (quantor, res, b);
 
   return res;
 }
 
 /*------------------------------------------------------------------------*/
-
-static Clause **
-findpos_BinDB (Quantor * quantor, BinDB * bindb, Clause * clause,
-	       int contained)
+/* Returns the entry of 'clause' or zero if it is not in the table.
+ */
+static BinDBEntry *
+findpos_BinDB (Quantor * quantor, BinDB * bindb, Clause * clause)
 {
-  Clause **p;
-  unsigned h;
+  BinDBEntry *e;
+  unsigned i;
 
   assert (quantor->opts.equivalences);
+  assert (clause->size == 2);
 
-  h = hash_Clause (quantor, clause);
-  h &= bindb->size - 1;
-  assert (h < bindb->size);
-  p = bindb->table + h;
-  while (*p &&
-	 (!contained || *p != clause) &&
-	 (contained || !eq_Clause (quantor, *p, clause)))
-    p = &(*p)->next_in_bindb;
+  i = hash2pos (hash_Clause (quantor, clause), bindb->size);
+  while ((e = bindb->table + i)->clause != clause)
+    {
+      if (!e->clause && !e->removed)
+	return 0;
+
+      i = (i + 1) & (bindb->size - 1);
+    }
 
-  return p;
+  return e;
 }
 
 /*------------------------------------------------------------------------*/
@@ -5839,8 +6472,9 @@ findpos_BinDB (Quantor * quantor, BinDB * bindb, Clause * clause,
 static Clause *
 find_binary_clause (Quantor * quantor, Lit * a, Lit * b)
 {
-  unsigned h;
-  Clause *res;
+  BinDBEntry *e;
+  unsigned h, i;
+  BinDB *bindb;
   Lit *tmp;
 
   assert (a != b);
@@ -5854,25 +6488,21 @@ find_binary_clause (Quantor * quantor, Lit * a, Lit * b)
       b = tmp;
     }
 
-  assert (cmp_lit (a, b) < 0);
-
-  h = extend_literal_hash_value (quantor, 0, a);
-  assert (h == hash_lit (quantor, a));
-  h = extend_literal_hash_value (quantor, h, b);
-  h &= quantor->bindb->size - 1;
-  assert (h < quantor->bindb->size);
+  bindb = quantor->bindb;
+  h = hash_binary_clause (quantor, a, b);
 
-  for (res = quantor->bindb->table[h]; res; res = res->next_in_bindb)
+  for (i = hash2pos (h, bindb->size);
+       (e = bindb->table + i)->clause || e->removed;
+       i = (i + 1) & (bindb->size - 1))
     {
-      assert (res->size == 2);
-
-      if (res->row[0].lit != a)
+      if (e->hash != h || e->a != a || e->b != b || !e->clause)
 	continue;
 
-      if (res->row[1].lit != b)
-	continue;
+      assert (e->clause->size == 2);
+      assert (e->clause->row[0].lit == a);
+      assert (e->clause->row[1].lit == b);
 
-      return res;
+      return e->clause;
     }
 
   return 0;
@@ -5887,12 +6517,13 @@ find_implication (Quantor * quantor, Lit * cond, Lit * concl)
 }
 
 /*------------------------------------------------------------------------*/
-
+/* Same as 'resize_RHSDB'.  Only the table is accessed.
+ */
 static void
 resize_BinDB (Quantor * quantor, BinDB * bindb)
 {
-  Clause **old_table, *p, *next;
-  unsigned old_size, h, i;
+  BinDBEntry *old_table, *p, *q;
+  unsigned old_size, i;
   size_t bytes;
 
   assert (quantor->opts.equivalences);
@@ -5900,21 +6531,23 @@ resize_BinDB (Quantor * quantor, BinDB * bindb)
   old_table = bindb->table;
   old_size = bindb->size;
 
-  bindb->size *= 2;
+  if (4 * (bindb->count + 1) > old_size)
+    bindb->size *= 2;
+
   bytes = bindb->size * sizeof (bindb->table[0]);
   bindb->table = new (quantor, bytes);
+  bindb->used = bindb->count;
 
-  for (i = 0; i < old_size; i++)
+  for (p = old_table; p < old_table + old_size; p++)
     {
-      for (p = old_table[i]; p; p = next)
-	{
-	  next = p->next_in_bindb;
-	  h = hash_Clause (quantor, p);
-	  h &= bindb->size - 1;
-	  assert (h < bindb->size);
-	  p->next_in_bindb = bindb->table[h];
-	  bindb->table[h] = p;
-	}
+      if (!p->clause)
+	continue;
+
+      for (i = hash2pos (p->hash, bindb->size);
+	   (q = bindb->table + i)->clause; i = (i + 1) & (bindb->size - 1))
+	;
+
+      *q = *p;
     }
 
   bytes = old_size * sizeof (old_table[0]);
@@ -5926,17 +6559,29 @@ resize_BinDB (Quantor * quantor, BinDB * bindb)
 static void
 insert_BinDB (Quantor * quantor, BinDB * bindb, Clause * clause)
 {
-  Clause **p;
+  BinDBEntry *e;
+  unsigned h, i;
 
   assert (quantor->opts.equivalences);
-  assert (!clause->next_in_bindb);
+  assert (clause->size == 2);
+  assert (!findpos_BinDB (quantor, bindb, clause));
 
-  if (bindb->size <= bindb->count)
+  if (2 * (bindb->used + 1) > bindb->size)
     resize_BinDB (quantor, bindb);
 
-  p = findpos_BinDB (quantor, bindb, clause, 0);
-  clause->next_in_bindb = *p;
-  *p = clause;
+  h = hash_Clause (quantor, clause);
+  for (i = hash2pos (h, bindb->size);
+       (e = bindb->table + i)->clause; i = (i + 1) & (bindb->size - 1))
+    ;
+
+  if (!e->removed)
+    bindb->used++;
+
+  e->hash = h;
+  e->removed = 0;
+  e->a = clause->row[0].lit;
+  e->b = clause->row[1].lit;
+  e->clause = clause;
 
   bindb->count++;
 }
@@ -5946,15 +6591,15 @@ insert_BinDB (Quantor * quantor, BinDB * bindb, Clause * clause)
 static void
 remove_BinDB (Quantor * quantor, BinDB * bindb, Clause * clause)
 {
-  Clause **p;
+  BinDBEntry *e;
 
   assert (quantor->opts.equivalences);
   assert (bindb->count > 0);
 
-  p = findpos_BinDB (quantor, bindb, clause, 1);
-  assert (*p == clause);
-  *p = clause->next_in_bindb;
-  clause->next_in_bindb = 0;
+  e = findpos_BinDB (quantor, bindb, clause);
+  assert (e);
+  e->clause = 0;
+  e->removed = 1;
 
   bindb->count--;
 }
@@ -6039,6 +6684,7 @@ register_binary_clause (Quantor * quantor, Clause * clause)
     return;
 
   insert_BinDB (quantor, quantor->bindb, clause);
+  quantor->new_binary_clauses++;
 
   dual_clause = find_dual_binary_clause (quantor, clause);
   if (dual_clause)
@@ -6821,6 +7467,7 @@ new_Clause (Quantor * quantor, const char *msg)
   check_clause_is_simplified (quantor, res);
   process_clause_size (quantor, res);
   initialize_clause_sig (quantor, res);
+  res->fresh = 1;
   dlink (&quantor->clauses, res, &res->link);
 
   return res;
@@ -6860,29 +7507,30 @@ mark_new_clause (Quantor * quantor, int new_mark)
 
 /*------------------------------------------------------------------------*/
 
+/* The literals of the new clause have to be marked with
+ * 'mark_new_clause' before.  This is done once for all candidates.  Most
+ * candidates are not subsumed, so we give up as soon as more literals of
+ * 'other' are unmarked than its size exceeds the size of the new clause.
+ */
 static int
-new_clause_subsumes (Quantor * quantor, Clause * other)
+marked_new_clause_subsumes (Quantor * quantor, Clause * other)
 {
-  unsigned count, size;
+  unsigned count, size, misses;
   Cell *q, *eor;
-  int res;
 
   size = count_PtrStack (&quantor->new_clause);
   assert (size <= other->size);
 
-  mark_new_clause (quantor, 1);
-
   count = 0;
+  misses = other->size - size;
   eor = end_of_row (other);
-  for (q = other->row; q < eor; q++)
+  for (q = other->row; count < size && q < eor; q++)
     if (q->lit->mark)
       count++;
+    else if (!misses--)
+      return 0;
 
-  res = (count == size);
-
-  mark_new_clause (quantor, 0);
-
-  return res;
+  return count == size;
 }
 
 /*------------------------------------------------------------------------*/
@@ -6952,6 +7600,7 @@ backward_subsume_from_new_clause (Quantor * quantor, const char *msg)
       assert (lit);
 
       num_subsumed = 0;
+      mark_new_clause (quantor, 1);
       for (q = lit->column.first; q; q = q->column_link.next)
 	{
 	  clause = q->clause;
@@ -6975,7 +7624,7 @@ backward_subsume_from_new_clause (Quantor * quantor, const char *msg)
 	  if (clause->size < size)
 	    continue;
 
-	  if (!new_clause_subsumes (quantor, clause))
+	  if (!marked_new_clause_subsumes (quantor, clause))
 	    continue;
 
 	  if (clause->size == size)
@@ -7009,6 +7658,7 @@ backward_subsume_from_new_clause (Quantor * quantor, const char *msg)
 
 	  num_subsumed++;
 	}
+      mark_new_clause (quantor, 0);
 
       if (!num_subsumed)
 	INCSTATS2 (quantor->stats.subsume.spurious);
@@ -7022,29 +7672,26 @@ backward_subsume_from_new_clause (Quantor * quantor, const char *msg)
 /*------------------------------------------------------------------------*/
 #ifndef NSTRENGTHEN
 /*------------------------------------------------------------------------*/
-
+/* The literals of the new clause have to be marked with 'mark_new_clause'
+ * before, once for all candidates.  The result is non zero iff exactly one
+ * literal of 'clause' is not marked.
+ */
 static int
 new_clause_subsumed_except_for_oneiteral (Quantor * quantor, Clause * clause)
 {
-  int count, size, res;
   Cell * q, * eor;
+  int misses;
 
-  size = count_PtrStack (&quantor->new_clause);
-  assert (size >= clause->size);
-
-  mark_new_clause (quantor, 1);
+  (void) quantor;
+  assert (count_PtrStack (&quantor->new_clause) >= clause->size);
 
-  count = 0;
+  misses = 0;
   eor = end_of_row (clause);
   for (q = clause->row; q < eor; q++)
-    if (q->lit->mark)
-      count++;
-
-  res = (count + 1 == clause->size);
-
-  mark_new_clause (quantor, 0);
+    if (!q->lit->mark && misses++)
+      return 0;
 
-  return res;
+  return misses == 1;
 }
 
 /*------------------------------------------------------------------------*/
@@ -7072,6 +7719,7 @@ forward_strengthen_new_clause (Quantor * quantor, const char *msg)
   INCSTATS2 (quantor->stats.strengthen.checks);
 
   sig = sig_new_clause (quantor);
+  mark_new_clause (quantor, 1);
 
   end_of_new_clause = quantor->new_clause.top;
   for (p = quantor->new_clause.start; p < end_of_new_clause; p++)
@@ -7098,6 +7746,8 @@ forward_strengthen_new_clause (Quantor * quantor, const char *msg)
 
 	  if (new_clause_subsumed_except_for_oneiteral (quantor, clause))
 	    {
+	      mark_new_clause (quantor, 0);
+
 	      while (++p < end_of_new_clause)
 		p[-1] = p[0];
 
@@ -7114,6 +7764,7 @@ forward_strengthen_new_clause (Quantor * quantor, const char *msg)
 	    }
 	}
     }
+  mark_new_clause (quantor, 0);
   INCSTATS2 (quantor->stats.strengthen.spurious);
 #else
   (void) quantor;
@@ -7324,84 +7975,450 @@ add_Scope (Quantor * quantor)
 /*------------------------------------------------------------------------*/
 
 static int
-get_char (Quantor * quantor)
+has_suffix (const char *str, const char *suffix)
 {
-  int ch;
-
-  if (quantor->parser.look_ahead != EOF)
-    {
-      ch = quantor->parser.look_ahead;
-      quantor->parser.look_ahead = EOF;
-    }
-  else
-    ch = fgetc (quantor->io.in);
-
-  if (ch == '\n')
-    quantor->parser.lineno++;
-
-  return ch;
+  size_t l = strlen (str), k = strlen (suffix);
+  return l >= k && !strcmp (str + l - k, suffix);
 }
 
 /*------------------------------------------------------------------------*/
+/* The compressed formats are decompressed in process if the corresponding
+ * library was found by 'configure', otherwise through an external command.
+ */
+static const char *decompressors[][2] = {
+  {".gz", "gunzip -c %s"},
+  {".bz2", "bzip2 -d -c %s"},
+  {".xz", "xz -d -c %s"},
+  {0, 0},
+};
 
-static void
-unget_char (Quantor * quantor, int ch)
+/*------------------------------------------------------------------------*/
+
+static const char *
+decompressor (const char *name)
 {
-  assert (quantor->parser.look_ahead == EOF);
+  int i;
 
-  if (ch == '\n')
-    {
-      assert (quantor->parser.lineno > 1);
-      quantor->parser.lineno--;
-    }
+  for (i = 0; decompressors[i][0]; i++)
+    if (has_suffix (name, decompressors[i][0]))
+      return decompressors[i][1];
 
-  quantor->parser.look_ahead = ch;
+  return 0;
 }
 
 /*------------------------------------------------------------------------*/
 
 static int
-read_unsigned (Quantor * quantor, int ch, int *res_ptr)
+open_compressed_input (Quantor * quantor, const char *name)
 {
-  int res, valid;
-
-  res = 0;
-  valid = 0;
+  const char *fmt = decompressor (name);
+  FILE *file;
+  char *cmd;
+  int len;
+#if defined(QUANTOR_HAVE_BZLIB) || defined(QUANTOR_HAVE_LZMA)
+  int error;
+#endif
+#ifdef QUANTOR_HAVE_ZLIB
+  int fd;
+#endif
 
-  if (isdigit (ch))
+  assert (fmt);
+  assert (!quantor->io.close_in && !quantor->io.pclose_in);
+#if defined(QUANTOR_HAVE_ZLIB) || defined(QUANTOR_HAVE_BZLIB) || \
+    defined(QUANTOR_HAVE_LZMA)
+  if (
+#ifdef QUANTOR_HAVE_ZLIB
+       has_suffix (name, ".gz") ||
+#endif
+#ifdef QUANTOR_HAVE_BZLIB
+       has_suffix (name, ".bz2") ||
+#endif
+#ifdef QUANTOR_HAVE_LZMA
+       has_suffix (name, ".xz") ||
+#endif
+       0)
     {
-      valid = 1;
-      res += ch - '0';		/* potentially non portable */
-    }
+      if (!(file = fopen (name, "rb")))
+	return 0;
 
-  for (;;)
-    {
-      ch = get_char (quantor);
-      if (!isdigit (ch))
-	break;
+      quantor->io.in = file;
+      quantor->io.close_in = 1;
+#ifdef QUANTOR_HAVE_ZLIB
+      if (has_suffix (name, ".gz"))
+	{
+	  if ((fd = dup (fileno (file))) < 0)
+	    return 0;
 
-      res = 10 * res + (ch - '0');	/* potentially non portable */
-      valid = 1;
+	  if (!(quantor->io.gzin = gzdopen (fd, "rb")))
+	    {
+	      close (fd);
+	      return 0;
+	    }
+
+	  return 1;
+	}
+#endif
+#ifdef QUANTOR_HAVE_BZLIB
+      if (has_suffix (name, ".bz2"))
+	{
+	  quantor->io.bzin = BZ2_bzReadOpen (&error, file, 0, 0, 0, 0);
+	  return error == BZ_OK;
+	}
+#endif
+#ifdef QUANTOR_HAVE_LZMA
+      if (has_suffix (name, ".xz"))
+	{
+	  lzma_stream init = LZMA_STREAM_INIT;
+
+	  quantor->io.xzin = new (quantor, sizeof (lzma_stream));
+	  *quantor->io.xzin = init;
+	  quantor->io.xzin_buffer = new (quantor, QUANTOR_PARSE_BUFFER_SIZE);
+	  error = lzma_stream_decoder (quantor->io.xzin,
+				       UINT64_MAX, LZMA_CONCATENATED);
+	  return error == LZMA_OK;
+	}
+#endif
     }
+#endif
+  len = strlen (name) + strlen (fmt);
+  cmd = new (quantor, len);
+  sprintf (cmd, fmt, name);
+  file = popen (cmd, "r");
+  delete (quantor, cmd, len);
 
-  unget_char (quantor, ch);
-  *res_ptr = res;
+  if (!file)
+    return 0;
 
-  return valid;
+  quantor->io.in = file;
+  quantor->io.pclose_in = 1;
+
+  return 1;
 }
 
 /*------------------------------------------------------------------------*/
 
-static int
-read_white_space (Quantor * quantor)
+static void
+close_compressed_input (Quantor * quantor)
 {
-  int valid, ch;
-
-  valid = 0;
-
-  while ((ch = get_char (quantor)) == ' ' || ch == '\t')
-    valid = 1;
-
+#ifdef QUANTOR_HAVE_BZLIB
+  int error;
+#endif
+#ifdef QUANTOR_HAVE_ZLIB
+  if (quantor->io.gzin)
+    gzclose (quantor->io.gzin);
+  quantor->io.gzin = 0;
+#endif
+#ifdef QUANTOR_HAVE_BZLIB
+  if (quantor->io.bzin)
+    BZ2_bzReadClose (&error, quantor->io.bzin);
+  quantor->io.bzin = 0;
+  quantor->io.bzin_done = 0;
+#endif
+#ifdef QUANTOR_HAVE_LZMA
+  if (quantor->io.xzin)
+    {
+      lzma_end (quantor->io.xzin);
+      delete (quantor, quantor->io.xzin, sizeof (lzma_stream));
+      delete (quantor, quantor->io.xzin_buffer, QUANTOR_PARSE_BUFFER_SIZE);
+    }
+  quantor->io.xzin = 0;
+  quantor->io.xzin_buffer = 0;
+#else
+  (void) quantor;
+#endif
+}
+
+/*------------------------------------------------------------------------*/
+
+static void
+close_input (Quantor * quantor)
+{
+  close_compressed_input (quantor);
+
+  if (quantor->io.close_in)
+    fclose (quantor->io.in);
+
+  if (quantor->io.pclose_in)
+    pclose (quantor->io.in);
+
+  quantor->io.close_in = 0;
+  quantor->io.pclose_in = 0;
+}
+
+/*------------------------------------------------------------------------*/
+#ifdef QUANTOR_HAVE_ZLIB
+/*------------------------------------------------------------------------*/
+/* On a truncated or corrupted stream 'gzread' may still return the bytes
+ * decompressed so far.  The error is only available through 'gzerror'.
+ */
+static int
+read_gz (Quantor * quantor, unsigned char *buffer, int size)
+{
+  int res, error;
+
+  res = gzread (quantor->io.gzin, buffer, size);
+  if (res < 0)
+    return -1;
+
+  (void) gzerror (quantor->io.gzin, &error);
+  if (error != Z_OK)
+    return -1;
+
+  return res;
+}
+
+/*------------------------------------------------------------------------*/
+#endif
+/*------------------------------------------------------------------------*/
+#ifdef QUANTOR_HAVE_LZMA
+/*------------------------------------------------------------------------*/
+
+static int
+read_xz (Quantor * quantor, unsigned char *buffer, int size)
+{
+  lzma_stream *xzin = quantor->io.xzin;
+  lzma_action action;
+  lzma_ret ret;
+
+  xzin->next_out = buffer;
+  xzin->avail_out = size;
+
+  while (xzin->avail_out)
+    {
+      if (!xzin->avail_in && !feof (quantor->io.in))
+	{
+	  xzin->next_in = quantor->io.xzin_buffer;
+	  xzin->avail_in = fread (quantor->io.xzin_buffer, 1,
+				  QUANTOR_PARSE_BUFFER_SIZE, quantor->io.in);
+	  if (ferror (quantor->io.in))
+	    return -1;
+	}
+
+      action = feof (quantor->io.in) ? LZMA_FINISH : LZMA_RUN;
+      ret = lzma_code (xzin, action);
+
+      if (ret == LZMA_STREAM_END)
+	break;
+
+      if (ret != LZMA_OK)
+	return -1;
+    }
+
+  return size - xzin->avail_out;
+}
+
+/*------------------------------------------------------------------------*/
+#endif
+/*------------------------------------------------------------------------*/
+
+/* Returns the number of bytes read, '0' at the end of the input and '-1'
+ * if reading or decompressing failed.
+ */
+static int
+read_input (Quantor * quantor, unsigned char *buffer, int size)
+{
+#ifdef QUANTOR_HAVE_BZLIB
+  int error, res;
+#endif
+#ifdef QUANTOR_HAVE_ZLIB
+  if (quantor->io.gzin)
+    return read_gz (quantor, buffer, size);
+#endif
+#ifdef QUANTOR_HAVE_BZLIB
+  if (quantor->io.bzin)
+    {
+      if (quantor->io.bzin_done)
+	return 0;
+
+      res = BZ2_bzRead (&error, quantor->io.bzin, buffer, size);
+      if (error == BZ_STREAM_END)
+	quantor->io.bzin_done = 1;
+      else if (error != BZ_OK)
+	return -1;
+
+      return res;
+    }
+#endif
+#ifdef QUANTOR_HAVE_LZMA
+  if (quantor->io.xzin)
+    return read_xz (quantor, buffer, size);
+#endif
+  size = fread (buffer, 1, size, quantor->io.in);
+
+  return ferror (quantor->io.in) ? -1 : size;
+}
+
+/*------------------------------------------------------------------------*/
+
+static int
+refill (Quantor * quantor)
+{
+  Parser *parser = &quantor->parser;
+  int bytes;
+
+  if (!parser->buffer)
+    return EOF;			/* end of in memory input */
+
+  bytes = read_input (quantor, parser->buffer, QUANTOR_PARSE_BUFFER_SIZE);
+  if (bytes < 0 && !parser->err)
+    parser->err = "failed to read or decompress input";
+
+  if (bytes <= 0)
+    return EOF;
+
+  parser->pos = parser->buffer;
+  parser->end = parser->buffer + bytes;
+
+  return *parser->pos++;
+}
+
+/*------------------------------------------------------------------------*/
+
+static int
+get_char (Quantor * quantor)
+{
+  Parser *parser = &quantor->parser;
+  int ch;
+
+  if (parser->look_ahead != EOF)
+    {
+      ch = parser->look_ahead;
+      parser->look_ahead = EOF;
+    }
+  else if (parser->pos < parser->end)
+    ch = *parser->pos++;
+  else
+    ch = refill (quantor);
+
+  if (ch == '\n')
+    parser->lineno++;
+
+  return ch;
+}
+
+/*------------------------------------------------------------------------*/
+
+static void
+unget_char (Quantor * quantor, int ch)
+{
+  assert (quantor->parser.look_ahead == EOF);
+
+  if (ch == '\n')
+    {
+      assert (quantor->parser.lineno > 1);
+      quantor->parser.lineno--;
+    }
+
+  quantor->parser.look_ahead = ch;
+}
+
+/*------------------------------------------------------------------------*/
+
+static int
+add_digit (int *res_ptr, int ch)
+{
+  int digit = ch - '0';		/* potentially non portable */
+
+  if (*res_ptr > (INT_MAX - digit) / 10)
+    return 0;
+
+  *res_ptr = 10 * *res_ptr + digit;
+
+  return 1;
+}
+
+/*------------------------------------------------------------------------*/
+
+static int
+read_unsigned (Quantor * quantor, int ch, int *res_ptr)
+{
+  Parser *parser = &quantor->parser;
+  const unsigned char *p;
+  int res, valid;
+
+  res = 0;
+  valid = 0;
+
+  if (isdigit (ch))
+    {
+      valid = 1;
+      res += ch - '0';		/* potentially non portable */
+    }
+
+  for (;;)
+    {
+      /* Scan the digits in the buffer directly and only go through
+       * 'get_char' at the end of the buffer.
+       */
+      if (parser->look_ahead == EOF)
+	{
+	  for (p = parser->pos; valid >= 0 && p < parser->end && isdigit (*p);
+	       p++)
+	    valid = add_digit (&res, *p) ? 1 : -1;
+
+	  parser->pos = p;
+	}
+
+      if (valid < 0)
+	break;
+
+      ch = get_char (quantor);
+      if (!isdigit (ch))
+	{
+	  unget_char (quantor, ch);
+	  break;
+	}
+
+      valid = add_digit (&res, ch) ? 1 : -1;
+    }
+
+  *res_ptr = res;
+
+  return valid > 0;
+}
+
+/*------------------------------------------------------------------------*/
+
+static void
+skip_line (Quantor * quantor)
+{
+  Parser *parser = &quantor->parser;
+  const unsigned char *p;
+  int ch;
+
+  for (;;)
+    {
+      if (parser->look_ahead == EOF && parser->pos < parser->end)
+	{
+	  p = memchr (parser->pos, '\n', parser->end - parser->pos);
+	  if (p)
+	    {
+	      parser->pos = p + 1;
+	      parser->lineno++;
+	      return;
+	    }
+
+	  parser->pos = parser->end;
+	}
+
+      ch = get_char (quantor);
+      if (ch == EOF || ch == '\n')
+	return;
+    }
+}
+
+/*------------------------------------------------------------------------*/
+
+static int
+read_white_space (Quantor * quantor)
+{
+  int valid, ch;
+
+  valid = 0;
+
+  while ((ch = get_char (quantor)) == ' ' || ch == '\t')
+    valid = 1;
+
   unget_char (quantor, ch);
 
   return valid;
@@ -7425,7 +8442,7 @@ is_first_occurence_of_var (Quantor * quantor, int lit)
 static void
 dealloc_Clause (Quantor * quantor, Clause * clause)
 {
-  delete (quantor, clause, sizeof_Clause (clause->size));
+  delete_clause_memory (quantor, clause, sizeof_Clause (clause->size));
 }
 
 /*------------------------------------------------------------------------*/
@@ -7595,73 +8612,308 @@ gc (Quantor * quantor)
   gc_core (quantor);
 }
 
+/*------------------------------------------------------------------------*/
+#ifdef QUANTOR_FAST_ALLOC
 /*------------------------------------------------------------------------*/
 
 static int
-subsumes (Quantor * quantor, Clause * this, Clause * other)
+cmp_chunks (const void *p, const void *q)
 {
-  unsigned count;
-  Cell *p, *eor;
-  int res;
-
-  (void ) quantor;
-  assert (this->size <= other->size);
-
-  eor = end_of_row (this);
-  for (p = this->row; p < eor; p++)
-    p->lit->mark = 1;
+  Chunk *a = *(Chunk **) p, *b = *(Chunk **) q;
+  return (a < b) ? -1 : (a > b);
+}
 
-  count = 0;
-  eor = end_of_row (other);
-  for (p = other->row; p < eor; p++)
-    if (p->lit->mark)
-      count++;
+/*------------------------------------------------------------------------*/
+/* Index of the chunk in the sorted 'chunks' containing 'ptr'.
+ */
+static int
+find_chunk (Chunk ** chunks, int n, void *ptr)
+{
+  int l, r, m;
 
-  res = (count == this->size);
+  l = 0;
+  r = n - 1;
+  while (l < r)
+    {
+      m = (l + r + 1) / 2;
+      if ((void *) chunks[m] <= ptr)
+	l = m;
+      else
+	r = m - 1;
+    }
 
-  eor = end_of_row (this);
-  for (p = this->row; p < eor; p++)
-    p->lit->mark = 0;
+  assert (n > 0);
+  assert ((void *) chunks[l] <= ptr);
+  assert ((char *) ptr <
+	  (char *) &chunks[l]->data + chunks[l]->header.bytes);
 
-  return res;
+  return l;
 }
 
 /*------------------------------------------------------------------------*/
-/* This is only called in 'forward_subsume' where we in essence traverse the
- * clauses in reverse chronological order using the same check as for the
- * original backward subsumption checks:  
- *
- *   check whether younger clauses which are traversed earlier are
- *   subsumed by this older 'clause' given as argument
- *
- * This is equivalent of all the literals in 'clause' being contained in
- * the subsumed younger clauses.  The number of subsumed younger clauses
- * is returned.
- *
- * THIS FUNCTION IS VERY MUCH RELATED TO 'backward_subsume_from_new_clause'.
- * IF YOU MAKE CHANGES HERE YOU PROBABLY NEED TO DO THEM THERE AS WELL!
+/* Copy 'clause' to a new place taken from the clause free lists and
+ * redirect all pointers to it, from clause lists, occurrence lists,
+ * 'idx2clause', the binary clause hash table and functions.  The old
+ * place is not put back on a free list.
  */
-static int
-forward_subsume_clause (Quantor * quantor, Clause * clause)
+static void
+move_clause (Quantor * quantor, Clause * clause)
 {
-  Cell *p, *eor;
-  Clause *other;
-  Lit *lit;
-  int res;
+  Cell *c, *d, *eor;
+  Function *function;
+  Clause *copy;
+  BinDBEntry *e;
+  size_t bytes;
 
-  assert (clause->size > 0);
-  assert (clause->sig);
-  assert (!is_dying_clause (quantor, clause));
-  assert (clause->mark);
+  bytes = sizeof_Clause (clause->size);
+  copy = new_clause_memory (quantor, bytes);
+  memcpy (copy, clause, bytes);
+  quantor->clause_bytes -=
+    sizeof (void *) * ((bytes + sizeof (void *) - 1) / sizeof (void *));
 
-  INCSTATS2 (quantor->stats.subsume.checks);
+  move_dlink (&quantor->clauses, clause, copy, &copy->link);
+  if (copy->scope)
+    move_dlink (&copy->scope->clauses, clause, copy, &copy->scope_link);
+  move_dlink (&quantor->dying_clauses, clause, copy, &copy->dying_link);
+  move_dlink (&quantor->marked_clauses, clause, copy, &copy->marked_link);
+  move_dlink (&quantor->unprocessed_clauses,
+	      clause, copy, &copy->unprocessed_clauses_link);
 
-  eor = end_of_row (clause);
-  res = INT_MAX;
+  if (copy->idx < count_PtrStack (&quantor->idx2clause) &&
+      quantor->idx2clause.start[copy->idx] == clause)
+    quantor->idx2clause.start[copy->idx] = copy;
 
-  for (p = clause->row; res && p < eor; p++)
-    if (!sig_subset (clause->sig, p->lit->sigsum))
-      res = 0;
+  if (copy->size == 2 && quantor->bindb &&
+      (e = findpos_BinDB (quantor, quantor->bindb, clause)))
+    e->clause = copy;
+
+  for (function = copy->functions.first;
+       function; function = function->clause_link.next)
+    function->clause = copy;
+
+  if (copy->partner)
+    {
+      eor = end_of_row (copy);
+      for (c = copy->row; c < eor; c++)
+	for (function = c->lit->var->functions.first;
+	     function; function = function->lhs_link.next)
+	  if (function->partner == clause)
+	    function->partner = copy;
+    }
+
+  d = clause->row;
+  eor = end_of_row (copy);
+  for (c = copy->row; c < eor; c++, d++)
+    {
+      c->clause = copy;
+      move_dlink (&c->lit->column, d, c, &c->column_link);
+      if (copy->size == 2)
+	move_dlink (&c->lit->binary_clauses, d, c, &c->binary_clauses_link);
+    }
+}
+
+/*------------------------------------------------------------------------*/
+/* Clauses are never freed back to 'malloc' individually.  After many
+ * eliminations the live clauses are scattered over mostly empty chunks.
+ * If enough of 'clause_chunks' is unused, the live clauses of chunks
+ * which are at most half full are moved to free places in the other
+ * chunks, or new ones, and the evacuated chunks are released.
+ */
+static void
+compact_clauses (Quantor * quantor)
+{
+  Chunk **chunks, *chunk, *next, **q;
+  unsigned size_class, evacuated;
+  size_t free_bytes, released;
+  Clause *clause, *next_clause;
+  void **p, *elem;
+  double moved;
+  int i, n, *live;
+
+  if (quantor->opts.compact <= 0 || quantor->dying_clauses.first)
+    return;
+
+  assert (quantor->clause_chunk_bytes >= quantor->clause_bytes);
+  free_bytes = quantor->clause_chunk_bytes - quantor->clause_bytes;
+  if (free_bytes < QUANTOR_MIN_COMPACT_BYTES ||
+      free_bytes < quantor->compact_limit)
+    return;
+
+  if (100.0 * free_bytes < quantor->opts.compact *
+      (double) quantor->clause_chunk_bytes)
+    return;
+
+  n = 0;
+  for (chunk = quantor->clause_chunks; chunk; chunk = chunk->header.next)
+    n++;
+
+  chunks = new (quantor, n * sizeof (chunks[0]));
+  live = new (quantor, n * sizeof (live[0]));
+
+  i = 0;
+  for (chunk = quantor->clause_chunks; chunk; chunk = chunk->header.next)
+    chunks[i++] = chunk;
+
+  qsort (chunks, n, sizeof (chunks[0]), cmp_chunks);
+
+  for (clause = quantor->clauses.first; clause; clause = clause->link.next)
+    if (sizeof_Clause (clause->size) <= QUANTOR_MAX_POOLED_BYTES)
+      live[find_chunk (chunks, n, clause)]++;
+
+  /* Chunks to be evacuated are marked by a zero 'nelems'.
+   */
+  evacuated = 0;
+  for (i = 0; i < n; i++)
+    if (2 * live[i] <= chunks[i]->header.nelems)
+      {
+	chunks[i]->header.nelems = 0;
+	evacuated++;
+      }
+
+  if (evacuated)
+    {
+      for (size_class = 0; size_class < QUANTOR_NUM_SIZE_CLASSES;
+	   size_class++)
+	{
+	  p = quantor->free_clauses + size_class;
+	  while ((elem = *p))
+	    {
+	      if (!chunks[find_chunk (chunks, n, elem)]->header.nelems)
+		*p = *(void **) elem;
+	      else
+		p = elem;
+	    }
+	}
+
+      moved = 0;
+      for (clause = quantor->clauses.first; clause; clause = next_clause)
+	{
+	  next_clause = clause->link.next;
+	  if (sizeof_Clause (clause->size) > QUANTOR_MAX_POOLED_BYTES)
+	    continue;
+
+	  if (chunks[find_chunk (chunks, n, clause)]->header.nelems)
+	    continue;
+
+	  move_clause (quantor, clause);
+	  moved++;
+	}
+      (void) moved;
+
+      released = 0;
+      q = &quantor->clause_chunks;
+      while ((chunk = *q))
+	{
+	  next = chunk->header.next;
+	  if (!chunk->header.nelems)
+	    {
+	      *q = next;
+	      released += chunk->header.bytes;
+	      delete (quantor, chunk, chunk->header.bytes + CHUNK_DATA_OFFSET);
+	    }
+	  else
+	    q = &chunk->header.next;
+	}
+
+      assert (quantor->clause_chunk_bytes >= released);
+      quantor->clause_chunk_bytes -= released;
+#ifdef QUANTOR_STATS1
+      quantor->stats.compactions++;
+      quantor->stats.moved_clauses += moved;
+      quantor->stats.released_bytes += released;
+#endif
+#ifdef QUANTOR_LOG2
+      LOG (quantor, 2,
+	   "COMPACTION MOVED %.0f CLAUSES AND RELEASED %u OF %d CHUNKS",
+	   moved, evacuated, n);
+#endif
+    }
+
+  delete (quantor, live, n * sizeof (live[0]));
+  delete (quantor, chunks, n * sizeof (chunks[0]));
+
+  /* Do not try again before twice as much memory is unused.
+   */
+  quantor->compact_limit =
+    2 * (quantor->clause_chunk_bytes - quantor->clause_bytes);
+}
+
+/*------------------------------------------------------------------------*/
+#endif
+/*------------------------------------------------------------------------*/
+
+/*------------------------------------------------------------------------*/
+
+static void
+mark_clause (Clause * clause, int new_mark)
+{
+  Cell *p, *eor;
+
+  eor = end_of_row (clause);
+  for (p = clause->row; p < eor; p++)
+    p->lit->mark = new_mark;
+}
+
+/*------------------------------------------------------------------------*/
+/* The literals of 'this' have to be marked with 'mark_clause' before.
+ */
+static int
+marked_subsumes (Quantor * quantor, Clause * this, Clause * other)
+{
+  unsigned count, misses;
+  Cell *p, *eor;
+
+  (void ) quantor;
+  assert (this->size <= other->size);
+
+  count = 0;
+  misses = other->size - this->size;
+  eor = end_of_row (other);
+  for (p = other->row; count < this->size && p < eor; p++)
+    if (p->lit->mark)
+      count++;
+    else if (!misses--)
+      return 0;
+
+  return count == this->size;
+}
+
+/*------------------------------------------------------------------------*/
+/* This is only called in 'forward_subsume' where we in essence traverse the
+ * clauses in reverse chronological order using the same check as for the
+ * original backward subsumption checks:  
+ *
+ *   check whether younger clauses which are traversed earlier are
+ *   subsumed by this older 'clause' given as argument
+ *
+ * This is equivalent of all the literals in 'clause' being contained in
+ * the subsumed younger clauses.  The number of subsumed younger clauses
+ * is returned.
+ *
+ * THIS FUNCTION IS VERY MUCH RELATED TO 'backward_subsume_from_new_clause'.
+ * IF YOU MAKE CHANGES HERE YOU PROBABLY NEED TO DO THEM THERE AS WELL!
+ */
+static int
+forward_subsume_clause (Quantor * quantor, Clause * clause)
+{
+  Cell *p, *eor;
+  Clause *other;
+  Lit *lit;
+  int res;
+
+  assert (clause->size > 0);
+  assert (clause->sig);
+  assert (!is_dying_clause (quantor, clause));
+  assert (clause->mark);
+
+  INCSTATS2 (quantor->stats.subsume.checks);
+
+  eor = end_of_row (clause);
+  res = INT_MAX;
+
+  for (p = clause->row; res && p < eor; p++)
+    if (!sig_subset (clause->sig, p->lit->sigsum))
+      res = 0;
 
   if (res)
     {
@@ -7675,6 +8927,7 @@ forward_subsume_clause (Quantor * quantor, Clause * clause)
       assert (lit);
 
       res = 0;
+      mark_clause (clause, 1);
       for (p = lit->column.first; p; p = p->column_link.next)
 	{
 	  other = p->clause;
@@ -7710,7 +8963,7 @@ forward_subsume_clause (Quantor * quantor, Clause * clause)
 	   * subsumption test, before we can conclude that the other clause
 	   * is allowed to be killed.
 	   */
-	  if (!subsumes (quantor, clause, other))
+	  if (!marked_subsumes (quantor, clause, other))
 	    continue;
 
 #ifdef QUANTOR_LOG6
@@ -7722,6 +8975,7 @@ forward_subsume_clause (Quantor * quantor, Clause * clause)
 	  kill_Clause (quantor, other);
 	  res++;
 	}
+      mark_clause (clause, 0);
 
       if (!res)
 	INCSTATS2 (quantor->stats.subsume.spurious);
@@ -7978,16 +9232,17 @@ new_Function (Quantor * quantor,
   Function *res;
   RHS *rhs;
 
-  if (contains_RHS (quantor, literals, size, &rhs))
+  if (contains_RHS (quantor, type, literals, size, &rhs))
     {
       if (!make_functions_with_same_rhs_consistent (quantor, type, lhs, rhs))
 	return 0;
     }
   else
-    rhs = insert_RHS (quantor, literals, size);
+    rhs = insert_RHS (quantor, type, literals, size);
 
-  res = new (quantor, sizeof (*res));
+  res = new_pooled (quantor, sizeof (*res));
   res->type = type;
+  res->partner = 0;
   res->lhs = lhs;
   dlink (&lhs->var->functions, res, &res->lhs_link);
 #ifdef QUANTOR_STATS1
@@ -8010,6 +9265,22 @@ new_Function (Quantor * quantor,
 #endif
   switch (type)
     {
+    case QUANTOR_ITE_GATE:
+#ifdef QUANTOR_STATS1
+#ifdef QUANTOR_LOG1
+      res->type_idx = quantor->stats.ite.new;
+#endif
+      type_stats = &quantor->stats.ite;
+#endif
+      break;
+    case QUANTOR_XOR_GATE:
+#ifdef QUANTOR_STATS1
+#ifdef QUANTOR_LOG1
+      res->type_idx = quantor->stats.xor.new;
+#endif
+      type_stats = &quantor->stats.xor;
+#endif
+      break;
     default:
       assert (type == QUANTOR_OR_GATE);
 #ifdef QUANTOR_STATS1
@@ -8199,120 +9470,459 @@ extract_or_gates (Quantor * quantor, Clause * clause)
 }
 
 /*------------------------------------------------------------------------*/
-
-static void
-process_clause (Quantor * quantor, Clause * clause)
+/* Find an active ternary clause with the literals 'a', 'b' and 'c'.  The
+ * signature of such a clause has to be contained in the signature sums of
+ * all its literals, which often avoids traversing a column.
+ */
+static Clause *
+find_ternary_clause (Quantor * quantor, Lit * a, Lit * b, Lit * c)
 {
-#ifdef QUANTOR_LOG8
-  LOG (quantor, 8, "PROCESSING CLAUSE %u", clause->idx);
-#endif
-  assert (clause->size >= 2);
-  assert (!is_dying_clause (quantor, clause));
-  assert (is_unprocessed_clause (quantor, clause));
+  Lit *lit, *min_lit;
+  Signature sig;
+  Clause *res;
+  Cell *p, *q;
+  int found;
 
-  INCSTATS2 (quantor->stats.processed);
+  sig = sig_lit (quantor, a) | sig_lit (quantor, b) | sig_lit (quantor, c);
+  if (!sig_subset (sig, a->sigsum) ||
+      !sig_subset (sig, b->sigsum) || !sig_subset (sig, c->sigsum))
+    return 0;
 
-#if 0
-  if (getenv ("ONLYCOUNT"))
-    {
-      remove_unprocessed_clauses (quantor, clause);
-      return;
-    }
-#endif
+  min_lit = a;
+  if (b->column.len < min_lit->column.len)
+    min_lit = b;
+  if (c->column.len < min_lit->column.len)
+    min_lit = c;
 
-  if (clause->processing_type == QUANTOR_FORWARD_PROCESSING)
-    {
-      INCSTATS2 (quantor->stats.forward_processed);
-    }
-  else
+  for (p = min_lit->column.first; p; p = p->column_link.next)
     {
-      assert (clause->processing_type == QUANTOR_BACKWARD_PROCESSING);
-      INCSTATS2 (quantor->stats.backward_processed);
-    }
-
-  external_unary_hyper_resolution (quantor, clause);
-
-  if (quantor->invalid || quantor->units.first)
-    return;
+      res = p->clause;
+      if (res->size != 3)
+	continue;
 
-  self_subsuming_unary_hyper_resolution (quantor, clause);
+      if (is_dying_clause (quantor, res))
+	continue;
 
-  if (quantor->invalid || quantor->units.first)
-    return;
+      found = 0;
+      for (q = res->row; q < res->row + 3; q++)
+	{
+	  lit = q->lit;
+	  if (lit == a || lit == b || lit == c)
+	    found++;
+	}
 
-  remove_unprocessed_clauses (quantor, clause);
+      if (found == 3)
+	return res;
+    }
 
-  extract_or_gates (quantor, clause);
+  return 0;
 }
 
 /*------------------------------------------------------------------------*/
 
-static void
-copy_clause_except (Quantor * quantor, Clause * clause, Lit * lit)
+static int
+contains_function (Quantor * quantor,
+		   FunctionType type, Lit * lhs, Lit ** literals, unsigned size)
 {
-  Cell *p, *eor;
+  Function *f;
+  RHS *rhs;
 
-  assert (!count_PtrStack (&quantor->new_clause));
+  if (!contains_RHS (quantor, type, literals, size, &rhs))
+    return 0;
 
-  eor = end_of_row (clause);
-  for (p = clause->row; p < eor; p++)
-    if (p->lit != lit)
-      push_PtrStack (quantor, &quantor->new_clause, p->lit);
+  for (f = rhs->functions.first; f; f = f->rhs_link.next)
+    if (f->lhs == lhs && !is_dying_Function (quantor, f))
+      return 1;
 
-  add_new_clause (quantor, "RESOLVED");
+  return 0;
 }
 
 /*------------------------------------------------------------------------*/
 
-static void
-unlink_unit_or_unate (Quantor * quantor, Var * v)
+static Function *
+new_gate (Quantor * quantor, FunctionType type,
+	  Lit * lhs, Lit ** literals, unsigned size,
+	  Clause * clause, Clause * partner)
 {
-  if (is_unit (quantor, v))
+  Function *res;
+
+  if (contains_function (quantor, type, lhs, literals, size))
+    return 0;
+
+  res = new_Function (quantor, type, lhs, literals, size);
+  if (!res)
     {
-      undlink (&quantor->units, v, &v->unit_link);
+      assert (quantor->invalid);
+      return 0;
     }
-  else
+
+  connect_clause_to_function (quantor, clause, res);
+  if (partner)
     {
-      assert (is_unate (quantor, v));
-      undlink (&quantor->unates, v, &v->unate_link);
+      res->partner = partner;
+      partner->partner = 1;
     }
+
+  return res;
 }
 
 /*------------------------------------------------------------------------*/
-
-static void
-kill_clauses_with_lit (Quantor * quantor, Lit * lit)
+/* The other ternary clauses of ITE and XOR gates with the ternary clause
+ * '(l[0] | l[1] | l[2])' have one literal 'l[k]' of this clause and the
+ * negations of the two others.  Bit 'k' of the result is set if such a
+ * clause is present.
+ */
+static unsigned
+find_dual_ternary_clauses (Quantor * quantor, Lit ** l)
 {
-  Cell *p, *next;
+  unsigned k, res;
 
-  for (p = lit->column.first; p; p = next)
-    {
-      next = p->column_link.next;
-#ifdef QUANTOR_LOG7
-      LOG (quantor, 7,
-	   "CLAUSE %d CONTAINS %d", p->clause->idx, lit2int (quantor, lit));
-#endif
-      kill_Clause (quantor, p->clause);
-    }
+  res = 0;
+  for (k = 0; k < 3; k++)
+    if (find_ternary_clause (quantor,
+			     (k == 0) ? l[0] : QUANTOR_NOT (l[0]),
+			     (k == 1) ? l[1] : QUANTOR_NOT (l[1]),
+			     (k == 2) ? l[2] : QUANTOR_NOT (l[2])))
+      res |= 1u << k;
+
+  return res;
 }
 
 /*------------------------------------------------------------------------*/
-
-static void
-remove_lit_in_clauses (Quantor * quantor, Lit * lit)
+/* The ternary clause '(a | b | c)' is part of an XOR gate if the three
+ * clauses with exactly two of its literals negated are present as well.
+ * Then 'a ^ b ^ c' is true, which gives three functions, one for each
+ * literal as LHS.  Negated arguments are normalized by negating the LHS.
+ */
+static unsigned
+extract_xor_gates (Quantor * quantor, Clause * clause, Lit ** l)
 {
-  Cell *p, *next;
-  Clause *clause;
+  Lit *lhs, *literals[2];
+  unsigned i, res;
 
-  for (p = lit->column.first; !quantor->invalid && p; p = next)
+  res = 0;
+  for (i = 0; !quantor->invalid && i < 3; i++)
     {
-      next = p->column_link.next;
-      clause = p->clause;
-#ifdef QUANTOR_LOG7
-      LOG (quantor, 7,
-	   "CLAUSE %d CONTAINS %d", p->clause->idx, lit2int (quantor, lit));
-#endif
-      kill_Clause (quantor, clause);
+      lhs = QUANTOR_NOT (l[i]);
+      literals[0] = l[i == 0];
+      literals[1] = l[(i == 2) ? 1 : 2];
+
+      if (is_signed (literals[0]))
+	{
+	  literals[0] = QUANTOR_NOT (literals[0]);
+	  lhs = QUANTOR_NOT (lhs);
+	}
+
+      if (is_signed (literals[1]))
+	{
+	  literals[1] = QUANTOR_NOT (literals[1]);
+	  lhs = QUANTOR_NOT (lhs);
+	}
+
+      if (new_gate (quantor, QUANTOR_XOR_GATE, lhs, literals, 2, clause, 0))
+	res++;
+    }
+
+  return res;
+}
+
+/*------------------------------------------------------------------------*/
+/* Find a ternary clause '(x | s | e)' with 'e' not on the variables of
+ * 'x', 's' and 'd', such that '(-x | s | -e)' is present as well.
+ */
+static Clause *
+find_ite_else_clause (Quantor * quantor,
+		      Lit * x, Lit * s, Lit * d, Lit ** else_ptr)
+{
+  Lit *lit, *min_lit, *e;
+  Clause *clause;
+  Cell *p, *q;
+  int found;
+
+  min_lit = (x->column.len <= s->column.len) ? x : s;
+
+  for (p = min_lit->column.first; p; p = p->column_link.next)
+    {
+      clause = p->clause;
+      if (clause->size != 3)
+	continue;
+
+      if (is_dying_clause (quantor, clause))
+	continue;
+
+      found = 0;
+      e = 0;
+      for (q = clause->row; q < clause->row + 3; q++)
+	{
+	  lit = q->lit;
+	  if (lit == x || lit == s)
+	    found++;
+	  else
+	    e = lit;
+	}
+
+      if (found != 2)
+	continue;
+
+      assert (e);
+      if (e->var == x->var || e->var == s->var || e->var == d->var)
+	continue;
+
+      if (!find_ternary_clause (quantor, QUANTOR_NOT (x), s, QUANTOR_NOT (e)))
+	continue;
+
+      *else_ptr = e;
+      return clause;
+    }
+
+  return 0;
+}
+
+/*------------------------------------------------------------------------*/
+/* The ternary clause '(x | s | d)' is part of an ITE gate if the clauses
+ *
+ *   (-x | s | -d)    (x | -s | e)    (-x | -s | -e)
+ *
+ * are present too.  Then 'x = s ? -e : -d'.  The condition and the 'then'
+ * literal are normalized to be positive.  The clause with the 'then'
+ * variable becomes the base clause of the function and the one with the
+ * 'else' variable its partner clause.
+ */
+static unsigned
+extract_ite_gates (Quantor * quantor,
+		   Clause * clause, Lit ** l, unsigned dual)
+{
+  Lit *x, *s, *d, *e, *lhs, *cond, *then_lit, *else_lit, *tmp;
+  Clause *then_clause, *else_clause, *other, *tmp_clause;
+  Lit *literals[3];
+  unsigned i, j, res;
+
+  res = 0;
+  for (j = 0; !quantor->invalid && j < 3; j++)
+    for (i = 0; !quantor->invalid && i < 3; i++)
+      {
+	if (i == j)
+	  continue;
+
+	/* The clause '(-x | s | -d)' has to be present.
+	 */
+	if (!(dual & (1u << j)))
+	  continue;
+
+	x = l[i];
+	s = l[j];
+	d = l[3 - i - j];
+
+	other = find_ite_else_clause (quantor, x, QUANTOR_NOT (s), d, &e);
+	if (!other)
+	  continue;
+
+	lhs = x;
+	cond = s;
+	then_lit = QUANTOR_NOT (e);
+	else_lit = QUANTOR_NOT (d);
+	then_clause = other;
+	else_clause = clause;
+
+	if (is_signed (cond))
+	  {
+	    cond = QUANTOR_NOT (cond);
+	    tmp = then_lit;
+	    then_lit = else_lit;
+	    else_lit = tmp;
+	    tmp_clause = then_clause;
+	    then_clause = else_clause;
+	    else_clause = tmp_clause;
+	  }
+
+	if (is_signed (then_lit))
+	  {
+	    then_lit = QUANTOR_NOT (then_lit);
+	    else_lit = QUANTOR_NOT (else_lit);
+	    lhs = QUANTOR_NOT (lhs);
+	  }
+
+	literals[0] = cond;
+	literals[1] = then_lit;
+	literals[2] = else_lit;
+
+	if (new_gate (quantor, QUANTOR_ITE_GATE,
+		      lhs, literals, 3, then_clause, else_clause))
+	  res++;
+      }
+
+  return res;
+}
+
+/*------------------------------------------------------------------------*/
+
+static void
+extract_ite_and_xor_gates (Quantor * quantor, Clause * clause)
+{
+  unsigned extractions, dual, i;
+  Lit *l[3];
+
+  if (clause->size != 3)
+    return;
+
+  if (!quantor->opts.ite_xor)
+    return;
+
+  if (quantor->invalid || is_dying_clause (quantor, clause))
+    return;
+
+  /* Resolvents and copies of clauses are only checked if the original
+   * formula has ITE or XOR gates at all.  Otherwise almost every new
+   * ternary clause would be checked in vain.
+   */
+  if (!clause->original && !quantor->ite_xor_gates)
+    return;
+
+  INCSTATS2 (quantor->stats.gate_extractions.checks);
+
+  for (i = 0; i < 3; i++)
+    l[i] = clause->row[i].lit;
+
+  dual = find_dual_ternary_clauses (quantor, l);
+  if (!dual)
+    return;
+
+  extractions = 0;
+  if (dual == 7)
+    extractions += extract_xor_gates (quantor, clause, l);
+
+  if (!quantor->invalid)
+    extractions += extract_ite_gates (quantor, clause, l, dual);
+
+  if (extractions)
+    INCSTATS2 (quantor->stats.gate_extractions.hits);
+
+  quantor->ite_xor_gates += extractions;
+
+#ifdef QUANTOR_LOG5
+  if (extractions)
+    LOG (quantor, 5,
+	 "EXTRACTED %u ITE AND XOR FUNCTIONS FROM CLAUSE %u",
+	 extractions, clause->idx);
+#endif
+}
+
+/*------------------------------------------------------------------------*/
+
+static void
+process_clause (Quantor * quantor, Clause * clause)
+{
+#ifdef QUANTOR_LOG8
+  LOG (quantor, 8, "PROCESSING CLAUSE %u", clause->idx);
+#endif
+  assert (clause->size >= 2);
+  assert (!is_dying_clause (quantor, clause));
+  assert (is_unprocessed_clause (quantor, clause));
+
+  INCSTATS2 (quantor->stats.processed);
+
+#if 0
+  if (getenv ("ONLYCOUNT"))
+    {
+      remove_unprocessed_clauses (quantor, clause);
+      return;
+    }
+#endif
+
+  if (clause->processing_type == QUANTOR_FORWARD_PROCESSING)
+    {
+      INCSTATS2 (quantor->stats.forward_processed);
+    }
+  else
+    {
+      assert (clause->processing_type == QUANTOR_BACKWARD_PROCESSING);
+      INCSTATS2 (quantor->stats.backward_processed);
+    }
+
+  external_unary_hyper_resolution (quantor, clause);
+
+  if (quantor->invalid || quantor->units.first)
+    return;
+
+  self_subsuming_unary_hyper_resolution (quantor, clause);
+
+  if (quantor->invalid || quantor->units.first)
+    return;
+
+  remove_unprocessed_clauses (quantor, clause);
+
+  extract_or_gates (quantor, clause);
+  extract_ite_and_xor_gates (quantor, clause);
+}
+
+/*------------------------------------------------------------------------*/
+
+static void
+copy_clause_except (Quantor * quantor, Clause * clause, Lit * lit)
+{
+  Cell *p, *eor;
+
+  assert (!count_PtrStack (&quantor->new_clause));
+
+  eor = end_of_row (clause);
+  for (p = clause->row; p < eor; p++)
+    if (p->lit != lit)
+      push_PtrStack (quantor, &quantor->new_clause, p->lit);
+
+  add_new_clause (quantor, "RESOLVED");
+}
+
+/*------------------------------------------------------------------------*/
+
+static void
+unlink_unit_or_unate (Quantor * quantor, Var * v)
+{
+  if (is_unit (quantor, v))
+    {
+      undlink (&quantor->units, v, &v->unit_link);
+    }
+  else
+    {
+      assert (is_unate (quantor, v));
+      undlink (&quantor->unates, v, &v->unate_link);
+    }
+}
+
+/*------------------------------------------------------------------------*/
+
+static void
+kill_clauses_with_lit (Quantor * quantor, Lit * lit)
+{
+  Cell *p, *next;
+
+  for (p = lit->column.first; p; p = next)
+    {
+      next = p->column_link.next;
+#ifdef QUANTOR_LOG7
+      LOG (quantor, 7,
+	   "CLAUSE %d CONTAINS %d", p->clause->idx, lit2int (quantor, lit));
+#endif
+      kill_Clause (quantor, p->clause);
+    }
+}
+
+/*------------------------------------------------------------------------*/
+
+static void
+remove_lit_in_clauses (Quantor * quantor, Lit * lit)
+{
+  Cell *p, *next;
+  Clause *clause;
+
+  for (p = lit->column.first; !quantor->invalid && p; p = next)
+    {
+      next = p->column_link.next;
+      clause = p->clause;
+#ifdef QUANTOR_LOG7
+      LOG (quantor, 7,
+	   "CLAUSE %d CONTAINS %d", p->clause->idx, lit2int (quantor, lit));
+#endif
+      kill_Clause (quantor, clause);
       copy_clause_except (quantor, clause, lit);
     }
 }
@@ -8437,13 +10047,15 @@ next_unprocessed_clause (Quantor * quantor)
 
 /*------------------------------------------------------------------------*/
 
-static void
+/* Resolves all units and unates.  Returns the number of resolved ones.
+ */
+static int
 unit_resolution (Quantor * quantor)
 {
+  int count;
   Var *v;
-#ifdef QUANTOR_LOG3
-  int count = 0;
-#endif
+
+  count = 0;
   gc (quantor);
 
   while (!quantor->invalid && (v = next_unit_or_unate_to_resolve (quantor)))
@@ -8460,8 +10072,8 @@ unit_resolution (Quantor * quantor)
 	  LOG (quantor, 4, "SCOPES AFTER %d UNIT RESOLUTION STEPS:", count);
 	  log_scopes (quantor, 4);
 	}
-      count++;
 #endif
+      count++;
       resolve_unit_or_unate (quantor, v);
       gc (quantor);
     }
@@ -8477,6 +10089,8 @@ unit_resolution (Quantor * quantor)
     }
 #endif
   check_invariant (quantor, 2);
+
+  return count;
 }
 
 /*------------------------------------------------------------------------*/
@@ -8719,9 +10333,13 @@ check_bcp_post_condition_clauses (Quantor * quantor)
 #endif
 /*------------------------------------------------------------------------*/
 
+/* If 'bcp' stopped early, only the units are guaranteed to be resolved.
+ */
 static void
-check_bcp_post_condition (Quantor * quantor)
+check_bcp_post_condition (Quantor * quantor, int complete)
 {
+  (void) complete;
+
   if (quantor->invalid)
     return;
 
@@ -8732,6 +10350,9 @@ check_bcp_post_condition (Quantor * quantor)
     return;
 
   assert (!quantor->units.first);
+  if (!complete)
+    return;
+
   assert (!quantor->unates.first);
   assert (!quantor->unprocessed_equivalence_classes.first);
   assert (!quantor->unprocessed_clauses.first);
@@ -8747,229 +10368,387 @@ check_bcp_post_condition (Quantor * quantor)
 
 /*------------------------------------------------------------------------*/
 
-static void
-bcp (Quantor * quantor)
+static Lit *
+other_binary_clause_lit (Cell * cell)
 {
-  EquivalenceClass *ec;
   Clause *clause;
-  int round;
 
-  gc (quantor);
+  clause = cell->clause;
+  assert (clause->size == 2);
 
-  round = 0;
+  return clause->row[cell == clause->row].lit;
+}
 
-  while (!quantor->invalid &&
-	 (next_unit_or_unate_to_resolve (quantor) ||
-	  next_unprocessed_equivalence_class (quantor) ||
-	  next_unprocessed_clause (quantor)))
+/*------------------------------------------------------------------------*/
+/* The literals 'start' to 'end' form a strongly connected component 'scc'
+ * of the binary implication graph and are thus equivalent.  All of them
+ * are assigned to the outermost one, which respects the quantifier
+ * prefix in the same way as equivalences from dual binary clauses.  The
+ * negations of these literals form a dual component.  Only the component
+ * which is completed first is merged.  Returns the number of equivalences.
+ */
+static int
+merge_strongly_connected_component (Quantor * quantor,
+				    Lit ** start, Lit ** end,
+				    int *low, int scc)
+{
+  Lit **p, *lit, *not_lit, *lhs, *rhs;
+  int res, other;
+
+  for (p = start; p < end; p++)
     {
-      if (!round)
-	{
-#ifdef QUANTOR_STATS1
-	  INCSTATS1 (quantor->stats.bcps);
-#ifdef QUANTOR_LOG4
-	  LOG (quantor, 4, "STARTING BCP %0.f", quantor->stats.bcps);
-#endif
-#endif
-	}
+      not_lit = QUANTOR_NOT (*p);
+      if (!not_lit->mark)
+	continue;
 
-      round++;
-#ifdef QUANTOR_STATS2
-      quantor->stats.bcp_rounds++;
-#ifdef QUANTOR_LOG4
-      LOG (quantor, 4, "BCP %0.f ROUND %d", quantor->stats.bcps, round);
-#endif
-#endif
-      if (next_unit_or_unate_to_resolve (quantor))
-	{
-	  unit_resolution (quantor);
-	  continue;
-	}
+      other = low[not_lit->mark - 1];
+      if (other >= 0)
+	continue;
 
-      if ((ec = next_unprocessed_equivalence_class (quantor)))
-	{
-	  process_equivalence_class (quantor, ec);
-	  continue;
-	}
-
-      if ((clause = next_unprocessed_clause (quantor)))
-	process_clause (quantor, clause);
-    }
+      if (other != -1 - scc)
+	return 0;
 
-#if defined(QUANTOR_STATS1) && defined(QUANTOR_LOG4)
-  if (round)
-    LOG (quantor, 4, "FINISHED BCP %0.f IN %d ROUNDS",
-	 quantor->stats.bcps, round);
+#ifdef QUANTOR_LOG2
+      LOG (quantor, 2, "LITERAL %d EQUIVALENT TO ITS NEGATION",
+	   lit2int (quantor, *p));
 #endif
+      register_invalidity (quantor);
+      return 0;
+    }
 
-  check_bcp_post_condition (quantor);
-}
+  rhs = *start;
+  for (p = start + 1; p < end; p++)
+    if (cmp_literals_by_nesting_level (*p, rhs) < 0)
+      rhs = *p;
 
-/*------------------------------------------------------------------------*/
+  res = 0;
+  for (p = start; !quantor->invalid && p < end; p++)
+    {
+      lit = *p;
+      if (lit == rhs)
+	continue;
 
-static void
-forward_subsume_core (Quantor * quantor)
-{
-  int num_subsumed_clauses;
-  Clause *c, *prev;
+      lhs = lit;
+      if (QUANTOR_SIGN (lhs))
+	{
+	  lhs = QUANTOR_NOT (lhs);
+	  rhs = QUANTOR_NOT (rhs);
+	}
 
-#ifdef QUANTOR_CHECK
-  if (quantor->opts.check >= 2)
-    check_no_backward_subsumptions (quantor);
+#ifdef QUANTOR_LOG5
+      LOG (quantor, 5, "NEW EQUIVALENCE %d = %d FROM COMPONENT %d",
+	   lit2int (quantor, lhs), lit2int (quantor, rhs), scc);
 #endif
+      INCSTATS1 (quantor->stats.equivalences);
+      INCSTATS2 (quantor->stats.equivalences_from_sccs);
+      assign (quantor, lhs->var, rhs);
+      res++;
 
-  clear_sigs (quantor);
-
-  for (c = quantor->clauses.first; c; c = c->link.next)
-    c->mark = 1;
-
-  num_subsumed_clauses = 0;
-  for (c = quantor->clauses.last; c; c = prev)
-    {
-      prev = c->link.prev;
-      num_subsumed_clauses += forward_subsume_clause (quantor, c);
+      if (lhs != lit)
+	rhs = QUANTOR_NOT (rhs);
     }
 
-#ifdef QUANTOR_LOG3
-  LOG (quantor, 3, "FORWARD SUBSUMED %d CLAUSES", num_subsumed_clauses);
-#endif
-  gc_core (quantor);
-#ifndef NDEBUG
-  for (c = quantor->clauses.first; c; c = c->link.next)
-    assert (!c->mark);
-#endif
-#ifdef QUANTOR_CHECK
-  if (quantor->opts.check >= 2)
-    check_no_forward_subsumptions (quantor);
-#endif
+  return res;
 }
 
 /*------------------------------------------------------------------------*/
-/* Since forward subsumption is too expensive to be performed on-the-fly.
- * In certain intervals we go over all clauses again and check for forward
- * subsumed clauses by, essentially, performing backward subsumption.
+/* Equivalences from dual binary clauses are found as soon as the second
+ * clause is added.  Longer cycles of implications are found here as the
+ * strongly connected components of the binary implication graph, where a
+ * binary clause '(a | b)' gives the edges '-a -> b' and '-b -> a'.  This
+ * is an iterative version of Tarjan's algorithm.  The DFS index plus one
+ * of a visited literal is stored in its 'mark'.  Its 'low' value is
+ * replaced by '-1 - scc' as soon as its component 'scc' is completed.
+ *
+ * The graph is only decomposed again if at least '--scc=<percent>' of the
+ * binary clauses are new.  Returns the number of new equivalences, which
+ * is zero if the formula turned out to be invalid.
  */
-static void
-forward_subsume (Quantor * quantor)
+static int
+decompose (Quantor * quantor)
 {
-  if (!quantor->opts.forward_subsume)
-    return;
+  int res, scc, i, j, *low;
+  PtrStack lits, stack, work;
+  Lit *root, *u, *w, **p;
+  IntStack lows;
+  Scope *scope;
+  Cell *cell;
+  int sign;
+  Var *v;
 
-  if (quantor->invalid)
-    return;
+  if (!quantor->opts.scc || quantor->invalid)
+    return 0;
 
-  gc_core (quantor);
-  forward_subsume_core (quantor);
-  bcp (quantor);
+  if (!quantor->new_binary_clauses)
+    return 0;
+
+  if (100.0 * quantor->new_binary_clauses <
+      quantor->opts.scc * (double) quantor->bindb->count)
+    return 0;
+
+  quantor->new_binary_clauses = 0;
+  INCSTATS2 (quantor->stats.decompositions);
+
+  init_PtrStack (quantor, &lits);
+  init_PtrStack (quantor, &stack);
+  init_PtrStack (quantor, &work);
+  memset (&lows, 0, sizeof (lows));
+
+  res = 0;
+  scc = 0;
+
+  for (scope = quantor->scopes.first; scope; scope = scope->link.next)
+    for (v = scope->vars.first; v; v = v->scope_link.next)
+      for (sign = 0; sign <= 1; sign++)
+	{
+	  root = var2lit (v, sign);
+	  if (root->mark)
+	    continue;
+
+	  if (!QUANTOR_NOT (root)->binary_clauses.len)
+	    continue;
+
+	  w = root;
+
+	VISIT:
+	  assert (!w->mark);
+	  w->mark = count_PtrStack (&lits) + 1;
+	  push_PtrStack (quantor, &lits, w);
+	  push_IntStack (quantor, &lows, w->mark - 1);
+	  push_PtrStack (quantor, &stack, w);
+	  push_PtrStack (quantor, &work, w);
+	  push_PtrStack (quantor, &work,
+			 QUANTOR_NOT (w)->binary_clauses.first);
+
+	  while (count_PtrStack (&work))
+	    {
+	      u = work.top[-2];
+	      i = u->mark - 1;
+	      low = lows.start;
+
+	      if ((cell = work.top[-1]))
+		{
+		  work.top[-1] = cell->binary_clauses_link.next;
+		  w = other_binary_clause_lit (cell);
+		  if (!w->mark)
+		    goto VISIT;
+
+		  j = w->mark - 1;
+		  if (low[j] >= 0 && j < low[i])
+		    low[i] = j;
+
+		  continue;
+		}
+
+	      reset_PtrStack (quantor, &work, count_PtrStack (&work) - 2);
+
+	      if (low[i] == i)
+		{
+		  for (p = (Lit **) stack.top - 1; *p != u; p--)
+		    ;
+
+		  for (j = 0; p + j < (Lit **) stack.top; j++)
+		    low[p[j]->mark - 1] = -1 - scc;
+
+		  if (j > 1)
+		    res += merge_strongly_connected_component (quantor,
+							       p, p + j,
+							       low, scc);
+		  scc++;
+		  stack.top = (void **) p;
+
+		  if (quantor->invalid)
+		    goto DONE;
+		}
+	      else if (count_PtrStack (&work))
+		{
+		  j = ((Lit *) work.top[-2])->mark - 1;
+		  if (low[i] < low[j])
+		    low[j] = low[i];
+		}
+	    }
+	}
+
+DONE:
+  for (p = (Lit **) lits.start; p < (Lit **) lits.top; p++)
+    (*p)->mark = 0;
+
+  release_IntStack (quantor, &lows);
+  release_PtrStack (quantor, &work);
+  release_PtrStack (quantor, &stack);
+  release_PtrStack (quantor, &lits);
+
+#ifdef QUANTOR_LOG4
+  LOG (quantor, 4, "FOUND %d EQUIVALENCES IN %d COMPONENTS", res, scc);
+#endif
+
+  return quantor->invalid ? 0 : res;
 }
 
 /*------------------------------------------------------------------------*/
 
+/* The lists of units, unates, unprocessed equivalence classes and
+ * unprocessed clauses are FIFO work queues, which are drained in this
+ * order, since resolving units removes most of the other work.  Every
+ * resolved unit or unate and every processed equivalence class or clause
+ * is one step.  Processing clauses only simplifies the formula further.
+ * After '--bcp-budget' steps it is stopped and the remaining clauses stay
+ * queued for the next call.  If only unates and equivalence classes are
+ * left in an empty formula, they are not needed either.
+ */
 static void
-register_propositional_original_problem (Quantor * quantor)
+start_bcp_round (Quantor * quantor, int round)
 {
-  quantor->original_problem_is_propositional = 1;
-  quantor->save_dead_original_clauses = quantor->opts.resolve_exported;
+  if (round == 1)
+    {
+#ifdef QUANTOR_STATS1
+      INCSTATS1 (quantor->stats.bcps);
+#ifdef QUANTOR_LOG4
+      LOG (quantor, 4, "STARTING BCP %0.f", quantor->stats.bcps);
+#endif
+#endif
+    }
+#ifdef QUANTOR_STATS2
+  quantor->stats.bcp_rounds++;
+#ifdef QUANTOR_LOG4
+  LOG (quantor, 4, "BCP %0.f ROUND %d", quantor->stats.bcps, round);
+#endif
+#else
+  (void) quantor;
+  (void) round;
+#endif
 }
 
 /*------------------------------------------------------------------------*/
 
-static int
-scope_or_clause_not_closed (Quantor * quantor)
+static void
+bcp (Quantor * quantor)
 {
-  if (count_IntStack (&quantor->external_literals))
-    return 1;
+  EquivalenceClass *ec;
+  int round, prev_phase, complete;
+  unsigned steps, budget;
+  Clause *clause;
 
-  if (count_IntStack (&quantor->external_scope))
-    return 1;
+  prev_phase = enter_phase (quantor, QUANTOR_PHASE_BCP);
+  gc (quantor);
 
-  if (quantor->external_type != QUANTOR_UNDEFINED_TYPE)
-    return 1;
+  budget = (quantor->opts.bcp_budget > 0) ?
+    (unsigned) quantor->opts.bcp_budget : UINT_MAX;
+  complete = 1;
+  round = 0;
+  steps = 0;
 
-  return 0;
-}
+  while (!quantor->invalid)
+    {
+      if (!quantor->units.first && !quantor->stats.num_active_clauses)
+	{
+	  complete = 0;
+	  break;
+	}
 
-/*------------------------------------------------------------------------*/
+      if (next_unit_or_unate_to_resolve (quantor))
+	{
+	  start_bcp_round (quantor, ++round);
+	  steps += unit_resolution (quantor);
+	}
+      else if ((ec = next_unprocessed_equivalence_class (quantor)))
+	{
+	  start_bcp_round (quantor, ++round);
+	  process_equivalence_class (quantor, ec);
+	  steps++;
+	}
+      else if (steps >= budget)
+	{
+	  complete = !next_unprocessed_clause (quantor);
+	  break;
+	}
+      else if ((clause = next_unprocessed_clause (quantor)))
+	{
+	  start_bcp_round (quantor, ++round);
+	  process_clause (quantor, clause);
+	  steps++;
+	}
+      else if (decompose (quantor))
+	start_bcp_round (quantor, ++round);
+      else
+	break;
+    }
 
-static QuantorQuantificationType
-char2qtype (char ch)
-{
-  assert (ch == 'a' || ch == 'e');
-  return (ch == 'a') ?
-   QUANTOR_UNIVERSAL_VARIABLE_TYPE : QUANTOR_EXISTENTIAL_VARIABLE_TYPE;
+#ifdef QUANTOR_STATS2
+  quantor->stats.bcp_steps += steps;
+  if (!complete && quantor->stats.num_active_clauses)
+    quantor->stats.bcp_interrupted++;
+#endif
+#if defined(QUANTOR_STATS1) && defined(QUANTOR_LOG4)
+  if (round)
+    LOG (quantor, 4, "FINISHED BCP %0.f IN %d ROUNDS AND %u STEPS",
+	 quantor->stats.bcps, round, steps);
+#endif
+
+  check_bcp_post_condition (quantor, complete);
+  leave_phase (quantor, prev_phase);
 }
 
 /*------------------------------------------------------------------------*/
 
-const char *
-quantor_scope (Quantor * quantor, QuantorQuantificationType type)
+/* Fresh clauses have been added since the last forward subsumption round.
+ * Since new clauses are appended to 'quantor->clauses' they form a suffix
+ * of this list.
+ */
+static Clause *
+first_fresh_clause (Quantor * quantor, unsigned *count_ptr)
 {
-  const char * res;
-
-  assert (type == QUANTOR_UNIVERSAL_VARIABLE_TYPE ||
-	  type == QUANTOR_EXISTENTIAL_VARIABLE_TYPE);
+  Clause *c, *res;
+  unsigned count;
 
+  count = 0;
   res = 0;
-
-  if (quantor->stats.external_clauses || scope_or_clause_not_closed (quantor))
+  for (c = quantor->clauses.last; c && c->fresh; c = c->link.prev)
     {
-      if (quantor->external_type == QUANTOR_UNDEFINED_TYPE)
-	res = "misplaced quantifier prefix";
-      else
-	res = "'0' missing";
+      res = c;
+      count++;
     }
-  else if (type == QUANTOR_UNIVERSAL_VARIABLE_TYPE)
-    quantor->external_type = QUANTOR_UNIVERSAL;
-  else
-    quantor->external_type = QUANTOR_EXISTENTIAL;
+
+  *count_ptr = count;
 
   return res;
 }
 
 /*------------------------------------------------------------------------*/
-
-const char *
-quantor_add (Quantor * quantor, int lit)
+/* The signature sums of the literals in fresh clauses only take fresh
+ * clauses into account.  A clause with a literal whose signature sum does
+ * not cover the signature of the clause does not subsume a fresh clause.
+ * The result is the number of occurrences of these literals, which have to
+ * be traversed by 'forward_subsume_fresh_clauses'.
+ */
+static double
+init_fresh_sigsums (Quantor * quantor, Clause * first)
 {
-  const char * res;
-  Scope * scope;
-
-  if (!quantor->scopes.last)
-    init_default_scope (quantor);
+  Cell *p, *eor;
+  double res;
+  Clause *c;
+  Lit *lit;
 
   res = 0;
 
-  if (lit)
-    {
-      if (quantor->external_type != QUANTOR_UNDEFINED_TYPE && lit < 0)
-	res = "negative quantified variable";
-      else
-	{
-	  if (is_first_occurence_of_var (quantor, lit))
-	    quantor->stats.external_vars++;
+  assert (!count_PtrStack (&quantor->fresh_lits));
 
-	  if (quantor->external_type == QUANTOR_UNDEFINED_TYPE)
-	    {
-	      push_IntStack (quantor, &quantor->external_literals, lit);
-	      quantor->stats.external_lits++;
-	    }
-	  else
-	    push_IntStack (quantor, &quantor->external_scope, lit);
-	}
-    }
-  else if (quantor->external_type == QUANTOR_UNDEFINED_TYPE)
-    {
-      add_external_clause (quantor);
-      quantor->stats.external_clauses++;
-    }
-  else
+  for (c = first; c; c = c->link.next)
     {
-      scope = add_Scope (quantor);
+      if (is_dying_clause (quantor, c))
+	continue;
 
-      if (!(res = check_and_internalize_scope (quantor, scope)))
+      assert (c->sig);
+      eor = end_of_row (c);
+      for (p = c->row; p < eor; p++)
 	{
-	  quantor->stats.external_scopes++;
-	  quantor->external_type = QUANTOR_UNDEFINED_TYPE;
+	  lit = p->lit;
+	  if (!lit->fresh_sigsum)
+	    {
+	      push_PtrStack (quantor, &quantor->fresh_lits, lit);
+	      res += lit->column.len;
+	    }
+	  lit->fresh_sigsum |= c->sig;
 	}
     }
 
@@ -8978,381 +10757,379 @@ quantor_add (Quantor * quantor, int lit)
 
 /*------------------------------------------------------------------------*/
 
-static int
-parse (Quantor * quantor)
+static void
+reset_fresh_sigsums (Quantor * quantor)
 {
-  Parser *parser = &quantor->parser;
-  int ch, sign, lit, max_idx;
-  double time;
+  void **p;
+  Lit *lit;
 
-  assert (!parser->parsing);
-  parser->parsing = 1;
+  for (p = quantor->fresh_lits.start; p < quantor->fresh_lits.top; p++)
+    {
+      lit = *p;
+      lit->fresh_sigsum = 0;
+    }
 
-  init_default_scope (quantor);
+  reset_PtrStack (quantor, &quantor->fresh_lits, 0);
+}
 
-  time = get_time ();
-#ifdef QUANTOR_LOG1
-  LOG (quantor, 1, "PARSING %s", quantor->io.in_name);
-#endif
-  assert (!count_IntStack (&quantor->external_scope));
-  assert (!count_IntStack (&quantor->external_literals));
-  assert (!parser->err);
-
-  assert (!quantor->stats.external_clauses);
-  assert (!quantor->stats.external_scopes);
-  assert (!quantor->stats.external_lits);
-  assert (!quantor->stats.external_vars);
+/*------------------------------------------------------------------------*/
 
-  parser->lineno = 1;
-  parser->look_ahead = EOF;
-  quantor->stats.specified_clauses = -1;
-  quantor->stats.specified_vars = -1;
-  max_idx = 0;
+static int
+may_subsume_fresh_clause (Clause * clause)
+{
+  Cell *p, *eor;
 
-  assert (quantor->external_type == QUANTOR_UNDEFINED_TYPE);
+  eor = end_of_row (clause);
+  for (p = clause->row; p < eor; p++)
+    if (!sig_subset (clause->sig, p->lit->fresh_sigsum))
+      return 0;
 
-  while (!parser->err && (ch = get_char (quantor)) != EOF)
-    {
-      if (ch == 'c')
-	{
-	  while ((ch = get_char (quantor)) != EOF && ch != '\n')
-	    ;
-	}
-      else if (ch == 'p')
-	{
-	  if (quantor->stats.specified_vars >= 0)
-	    parser->err = "multiple 'p' found";
-	  else if (scope_or_clause_not_closed (quantor) ||
-		   quantor->stats.external_clauses ||
-		   quantor->stats.external_scopes)
-	    parser->err = "misplaced 'p'";
-	  else if (!read_white_space (quantor) ||
-		   (get_char (quantor) != 'c') ||
-		   (get_char (quantor) != 'n') ||
-		   (get_char (quantor) != 'f') ||
-		   !read_white_space (quantor) ||
-		   !read_unsigned (quantor, ' ',
-				   &quantor->stats.specified_vars) ||
-		   !read_white_space (quantor) ||
-		   !read_unsigned (quantor, ' ',
-				   &quantor->stats.specified_clauses))
-	    parser->err = "malformend 'p cnf ...'";
-	}
-      else if (ch == '-' || isdigit (ch))
-	{
-	  if (ch == '-')
-	    {
-	      sign = -1;
-	      ch = get_char (quantor);
-	    }
-	  else
-	    sign = 1;
+  return 1;
+}
 
-	  if (!read_unsigned (quantor, ch, &lit))
-	    parser->err = "invalid literal";
-	  else
-	    {
-	      if (lit > max_idx)
-		max_idx = lit;
+/*------------------------------------------------------------------------*/
+/* Same as 'forward_subsume_clause' but only fresh clauses are candidates
+ * for being subsumed, no matter whether they are younger than 'clause'.
+ */
+static int
+forward_subsume_fresh_by_clause (Quantor * quantor, Clause * clause)
+{
+  Cell *p, *eor;
+  Clause *other;
+  Lit *lit;
+  int res;
 
-	      lit *= sign;
-	      parser->err = quantor_add (quantor, lit);
-	    }
-	}
-      else if (ch == 'a' || ch == 'e')
-	parser->err = quantor_scope (quantor, char2qtype (ch));
-      else if (ch != ' ' && ch != '\t' && ch != '\n')
-	parser->err = "invalid character";
+  lit = 0;
+  eor = end_of_row (clause);
+  for (p = clause->row; p < eor; p++)
+    {
+      if (!lit || lit->column.len > p->lit->column.len)
+	lit = p->lit;
     }
 
-  if (!parser->err && scope_or_clause_not_closed (quantor))
-    parser->err = "'0' missing";
-
-  if (!parser->err && quantor->stats.specified_vars < 0)
-    parser->err = "'p cnf ...' missing";
+  assert (lit);
 
-  if (!parser->err && quantor->stats.specified_vars < max_idx)
-    parser->err = "more variables found than specified";
+  res = 0;
+  mark_clause (clause, 1);
+  for (p = lit->column.first; p; p = p->column_link.next)
+    {
+      other = p->clause;
 
-  if (!parser->err &&
-      quantor->stats.specified_clauses != quantor->stats.external_clauses)
-    parser->err = "specified and actual number of clauses differ";
+      if (!other->fresh || other == clause)
+	continue;
 
-  if (!parser->err)
-    {
-      /* TODO factor out this code */
+      if (other->size < clause->size)
+	continue;
 
-      register_proposed_zombies (quantor);
-      register_proposed_unates (quantor);
-      quantor->no_more_external_vars = 1;
-#ifdef QUANTOR_LOG4
-      LOG (quantor, 4, "EXPORTED %d VARIABLES", quantor->stats.num_exported);
-#endif
-#ifdef QUANTOR_LOG4
-      LOG (quantor, 4, "SCOPES AFTER PARSING:");
-#endif
-#ifdef QUANTOR_LOG1
-      log_scopes (quantor, 1);
-#endif
-    }
+      if (!sig_subset (clause->sig, other->sig))
+	continue;
 
-  if (!quantor->stats.external_scopes)
-    {
-#ifdef QUANTOR_LOG1
-      LOG (quantor, 1, "INPUT IS PROPOSITIONAL (NO QUANTIFIERS)");
-#endif
-      register_propositional_original_problem (quantor);
-    }
+      if (is_dying_clause (quantor, other))
+	continue;
 
-  if (!parser->err && 
-      quantor->stats.external_scopes &&
-      default_scope (quantor)->vars.len)
-    parser->err = "unquantified variable in QBF instance";
+      if (!marked_subsumes (quantor, clause, other))
+	continue;
 
-  time = get_time () - time;
-  time = (time < 0) ? 0 : time;
-#ifdef QUANTOR_LOG1
-  LOG (quantor, 1, "PARSED %s", quantor->io.in_name);
-  LOG (quantor, 1, "  %d PARSED VARIABLES", quantor->stats.external_vars);
-  LOG (quantor, 1, "  %d PARSED CLAUSES", quantor->stats.external_clauses);
-  LOG (quantor, 1, "  %d PARSED LITERALS", quantor->stats.external_lits);
-  LOG (quantor, 1, "  %d PARSED SCOPES", quantor->stats.external_scopes);
-  LOG (quantor, 1, "PARSE TIME %.2f SECONDS", time);
+#ifdef QUANTOR_LOG6
+      LOG (quantor, 6,
+	   "FRESH CLAUSE %d IS FORWARD SUBSUMED BY CLAUSE %d",
+	   other->idx, clause->idx);
 #endif
+      INCSTATS2 (quantor->stats.forward_subsumed);
+      kill_Clause (quantor, other);
+      res++;
+    }
+  mark_clause (clause, 0);
 
-  assert (parser->parsing);
-  parser->parsing = 0;
-
-  return !parser->err;
+  return res;
 }
 
 /*------------------------------------------------------------------------*/
-
+/* With backward subsumption no clause is subsumed by a younger clause and
+ * clauses do not change after they have been added.  After a round of
+ * forward subsumption only fresh clauses can thus be subsumed.  A
+ * subsuming clause only contains literals of fresh clauses and is found
+ * exactly once through the column of its first literal.  Therefore only
+ * the columns of literals in fresh clauses are traversed.  Their signature
+ * sums have to be initialized with 'init_fresh_sigsums' before.
+ */
 static int
-is_empty_Scope (Scope * scope)
+forward_subsume_fresh_clauses (Quantor * quantor, Clause * first)
 {
-  return !scope->vars.first;
-}
+  int num_subsumed_clauses, count;
+  Clause *c, *clause;
+  unsigned i;
+  Cell *p;
+  Lit *lit;
 
-/*------------------------------------------------------------------------*/
+  INCSTATS2 (quantor->stats.forward_subsume_rounds);
 
-static int
-is_propositional (Quantor * quantor)
-{
-  Scope *p;
+  num_subsumed_clauses = 0;
+  for (i = 0; i < count_PtrStack (&quantor->fresh_lits); i++)
+    {
+      lit = quantor->fresh_lits.start[i];
+      for (p = lit->column.first; p; p = p->column_link.next)
+	{
+	  clause = p->clause;
 
-  if (quantor->invalid)
-    return 1;
+	  if (clause->row[0].lit != lit)
+	    continue;
 
-  for (p = quantor->scopes.first; p; p = p->link.next)
-    if (!is_empty_Scope (p) && p->type == QUANTOR_UNIVERSAL)
-      return 0;
+	  if (is_dying_clause (quantor, clause))
+	    continue;
 
-  return 1;
-}
+	  INCSTATS2 (quantor->stats.subsume.checks);
 
-/*------------------------------------------------------------------------*/
+	  if (!may_subsume_fresh_clause (clause))
+	    {
+	      INCSTATS2 (quantor->stats.subsume.hits);
+	      continue;
+	    }
 
-static int
-var_can_not_be_eliminated (Quantor * quantor, Var * var)
-{
-  if (var->eliminated)
-    return 1;
+	  count = forward_subsume_fresh_by_clause (quantor, clause);
+	  if (!count)
+	    INCSTATS2 (quantor->stats.subsume.spurious);
 
-  if (var->zombie)
-    return 1;
+	  num_subsumed_clauses += count;
+	}
+    }
 
-  if (var->exported && !quantor->opts.resolve_exported)
-    return 1;
+  reset_fresh_sigsums (quantor);
 
-  assert (!is_assigned_var (var));
+  for (c = first; c; c = c->link.next)
+    c->fresh = 0;
 
-  return 0;
+  return num_subsumed_clauses;
 }
 
-/*------------------------------------------------------------------------*/
-#ifdef QUANTOR_HAVE_DOUBLE_PRECISION_INT
 /*------------------------------------------------------------------------*/
 
 static int
-dpi2int (DPI dpi)
+forward_subsume_all_clauses (Quantor * quantor)
 {
-  if (dpi <= INT_MIN || dpi > QUANTOR_OVERFLOW)
-    return QUANTOR_OVERFLOW;
-  else
-    return (int) dpi;
-}
+  int num_subsumed_clauses;
+  Clause *c, *prev;
 
-/*------------------------------------------------------------------------*/
+  INCSTATS2 (quantor->stats.forward_subsume_sweeps);
 
-static int
-mult_with_overflow (int a, int b)
-{
-  if (!a || !b)
-    return 0;
+  clear_sigs (quantor);
 
-  if (a >= QUANTOR_OVERFLOW || b >= QUANTOR_OVERFLOW)
-    return QUANTOR_OVERFLOW;
+  for (c = quantor->clauses.first; c; c = c->link.next)
+    {
+      c->mark = 1;
+      c->fresh = 0;
+    }
 
-  return dpi2int (((DPI) a) * ((DPI) b));
+  num_subsumed_clauses = 0;
+  for (c = quantor->clauses.last; c; c = prev)
+    {
+      prev = c->link.prev;
+      num_subsumed_clauses += forward_subsume_clause (quantor, c);
+    }
+
+  return num_subsumed_clauses;
 }
 
 /*------------------------------------------------------------------------*/
 
-static int
-add_with_overflow (int a, int b)
+static void
+forward_subsume_core (Quantor * quantor)
 {
-  if (a >= QUANTOR_OVERFLOW || b >= QUANTOR_OVERFLOW)
-    return QUANTOR_OVERFLOW;
-
-  return dpi2int (((DPI) a) + ((DPI) b));
-}
+  double fresh_occurrences, occurrences;
+  int num_subsumed_clauses;
+  unsigned num_fresh;
+  Scope *scope;
+  Clause *first;
+#ifndef NDEBUG
+  Clause *c;
+#endif
 
-/*------------------------------------------------------------------------*/
-#else /* explicit saturating arithmetic without double precision int */
-/*------------------------------------------------------------------------*/
+#ifdef QUANTOR_CHECK
+  if (quantor->opts.check >= 2)
+    check_no_backward_subsumptions (quantor);
+#endif
 
-static int
-ldfloor2 (int n)
-{
-  if (n & 2)
-    return 1;
-  else
-    return 0;
-}
+  /* Traversing the columns of the literals in fresh clauses is slower
+   * than the sweep over all clauses for the same number of occurrences.
+   * Therefore only a small enough fraction of all occurrences is traversed.
+   */
+  num_subsumed_clauses = -1;
+  if (quantor->opts.backward_subsume &&
+      quantor->opts.forward_subsume_delta > 0)
+    {
+      first = first_fresh_clause (quantor, &num_fresh);
+      fresh_occurrences = init_fresh_sigsums (quantor, first);
 
-/*------------------------------------------------------------------------*/
+      occurrences = 0;
+      for (scope = quantor->scopes.first; scope; scope = scope->link.next)
+	occurrences += scope->sum;
 
-static int
-ldfloor4 (int n)
-{
-  if (n & 0xc)
-    return ldfloor2 (n >> 2) + 2;
-  else
-    return ldfloor2 (n);
+      if (100.0 * fresh_occurrences <=
+	  quantor->opts.forward_subsume_delta * occurrences)
+	{
+#ifdef QUANTOR_LOG3
+	  LOG (quantor, 3,
+	       "FORWARD SUBSUMING %u FRESH CLAUSES THROUGH %.0f OCCURRENCES",
+	       num_fresh, fresh_occurrences);
+#endif
+	  num_subsumed_clauses =
+	    forward_subsume_fresh_clauses (quantor, first);
+	}
+      else
+	reset_fresh_sigsums (quantor);
+    }
+
+  if (num_subsumed_clauses < 0)
+    num_subsumed_clauses = forward_subsume_all_clauses (quantor);
+
+#ifdef QUANTOR_LOG3
+  LOG (quantor, 3, "FORWARD SUBSUMED %d CLAUSES", num_subsumed_clauses);
+#else
+  (void) num_subsumed_clauses;
+#endif
+  gc_core (quantor);
+#ifndef NDEBUG
+  for (c = quantor->clauses.first; c; c = c->link.next)
+    assert (!c->mark && !c->fresh);
+#endif
+#ifdef QUANTOR_CHECK
+  if (quantor->opts.check >= 2)
+    check_no_forward_subsumptions (quantor);
+#endif
 }
 
 /*------------------------------------------------------------------------*/
-
-static int
-ldfloor8 (int n)
+/* Since forward subsumption is too expensive to be performed on-the-fly.
+ * In certain intervals we go over all clauses again and check for forward
+ * subsumed clauses by, essentially, performing backward subsumption.
+ */
+static void
+forward_subsume (Quantor * quantor)
 {
-  if (n & 0xf0)
-    return ldfloor4 (n >> 4) + 4;
-  else
-    return ldfloor4 (n);
+  int prev_phase;
+
+  if (!quantor->opts.forward_subsume)
+    return;
+
+  if (quantor->invalid)
+    return;
+
+  prev_phase = enter_phase (quantor, QUANTOR_PHASE_FORWARD_SUBSUME);
+  gc_core (quantor);
+  forward_subsume_core (quantor);
+  leave_phase (quantor, prev_phase);
+  bcp (quantor);
 }
 
 /*------------------------------------------------------------------------*/
 
-static int
-ldfloor16 (int n)
+static void
+register_propositional_original_problem (Quantor * quantor)
 {
-  if (n & 0xff00)
-    return ldfloor8 (n >> 8) + 8;
-  else
-    return ldfloor8 (n);
+  quantor->original_problem_is_propositional = 1;
+  quantor->save_dead_original_clauses = quantor->opts.resolve_exported;
 }
 
 /*------------------------------------------------------------------------*/
 
 static int
-ldfloor (int n)
+scope_or_clause_not_closed (Quantor * quantor)
 {
-  assert (n >= 0);
+  if (count_IntStack (&quantor->external_literals))
+    return 1;
 
-  if (n & 0xffff0000)
-    return ldfloor16 (n >> 16) + 16;
-  else
-    return ldfloor16 (n);
+  if (count_IntStack (&quantor->external_scope))
+    return 1;
+
+  if (quantor->external_type != QUANTOR_UNDEFINED_TYPE)
+    return 1;
+
+  return 0;
 }
 
 /*------------------------------------------------------------------------*/
-/* Returns the number of bits necessary to represent the given number.
- */
-static int
-num_bits (int n)
-{
-  assert (n >= 0);
 
-  return ldfloor (n) + 1;
+static QuantorQuantificationType
+char2qtype (char ch)
+{
+  assert (ch == 'a' || ch == 'e');
+  return (ch == 'a') ?
+   QUANTOR_UNIVERSAL_VARIABLE_TYPE : QUANTOR_EXISTENTIAL_VARIABLE_TYPE;
 }
 
 /*------------------------------------------------------------------------*/
-/* We work with a special saturating arithmetic by adding a new value
- * 'QUANTOR_OVERFLOW' which is a number slightly smaller than 'INT_MAX'.  The
- * arithmetic is 'saturating' in the sense that adding or multiplying any
- * value with 'QUANTOR_OVERFLOW' results in 'QUANTOR_OVERFLOW' as well.  In
- * addition we make sure that any real overflow during addition or
- * multiplication is detected and results in 'QUANTOR_OVERFLOW' to be returned.
- */
-static int
-mult_with_overflow (int a, int b)
+
+const char *
+quantor_scope (Quantor * quantor, QuantorQuantificationType type)
 {
-  int res, sign, tmp;
+  const char * res;
 
-  if (a == 0 || b == 0)
-    return 0;
+  assert (type == QUANTOR_UNIVERSAL_VARIABLE_TYPE ||
+	  type == QUANTOR_EXISTENTIAL_VARIABLE_TYPE);
 
-  if (a >= QUANTOR_OVERFLOW || b >= QUANTOR_OVERFLOW)
-    return QUANTOR_OVERFLOW;
+  res = 0;
 
-  if (a > b)
+  if (quantor->stats.external_clauses || scope_or_clause_not_closed (quantor))
     {
-      tmp = a;
-      a = b;
-      b = tmp;
+      if (quantor->external_type == QUANTOR_UNDEFINED_TYPE)
+	res = "misplaced quantifier prefix";
+      else
+	res = "'0' missing";
     }
+  else if (type == QUANTOR_UNIVERSAL_VARIABLE_TYPE)
+    quantor->external_type = QUANTOR_UNIVERSAL;
+  else
+    quantor->external_type = QUANTOR_EXISTENTIAL;
 
-  if (b < 0)
-    {
-      assert (a < 0);
+  return res;
+}
 
-      if (a == INT_MIN || b == INT_MIN)
-	return QUANTOR_OVERFLOW;
+/*------------------------------------------------------------------------*/
 
-      a = -a;
-      b = -b;
-      sign = 1;
-    }
-  else if (a < 0)
-    {
-      assert (b >= 0);
+const char *
+quantor_add (Quantor * quantor, int lit)
+{
+  const char * res;
+  Scope * scope;
 
-      if (a == INT_MIN)
-	return QUANTOR_OVERFLOW;
+  if (!quantor->scopes.last)
+    init_default_scope (quantor);
 
-      sign = -1;
-      a = -a;
-    }
-  else
-    {
-      assert (a > 0 && b > 0);
-      sign = 1;
-    }
+  res = 0;
 
-  if (a > b)
+  if (lit)
     {
-      tmp = a;
-      a = b;
-      b = tmp;
-    }
-
-  res = a * b;
+      if (quantor->external_type != QUANTOR_UNDEFINED_TYPE && lit < 0)
+	res = "negative quantified variable";
+      else
+	{
+	  if (is_first_occurence_of_var (quantor, lit))
+	    quantor->stats.external_vars++;
 
-  if (a == 1 || (a == 2 && num_bits (b) <= 30 && res > 0) ||
-      (a > 2 && (num_bits (a) + num_bits (b) <= 31)))
+	  if (quantor->external_type == QUANTOR_UNDEFINED_TYPE)
+	    {
+	      push_IntStack (quantor, &quantor->external_literals, lit);
+	      quantor->stats.external_lits++;
+	    }
+	  else
+	    push_IntStack (quantor, &quantor->external_scope, lit);
+	}
+    }
+  else if (quantor->external_type == QUANTOR_UNDEFINED_TYPE)
     {
-      assert (res > 0);
-
-      if (sign == -1)
-	res = -res;
+      add_external_clause (quantor);
+      quantor->stats.external_clauses++;
     }
   else
-    res = QUANTOR_OVERFLOW;
+    {
+      scope = add_Scope (quantor);
 
-  if (res >= QUANTOR_OVERFLOW)
-    res = QUANTOR_OVERFLOW;
+      if (!(res = check_and_internalize_scope (quantor, scope)))
+	{
+	  quantor->stats.external_scopes++;
+	  quantor->external_type = QUANTOR_UNDEFINED_TYPE;
+	}
+    }
 
   return res;
 }
@@ -9360,1600 +11137,2885 @@ mult_with_overflow (int a, int b)
 /*------------------------------------------------------------------------*/
 
 static int
-add_with_overflow (int a, int b)
+parse (Quantor * quantor)
 {
-  int sign, tmp, res;
-
-  if (a >= QUANTOR_OVERFLOW || b >= QUANTOR_OVERFLOW)
-    return QUANTOR_OVERFLOW;
-  else if ((a <= 0 && b >= 0) || (a >= 0 && b <= 0))
-    return a + b;
+  Parser *parser = &quantor->parser;
+  int ch, sign, lit, max_idx, prev_phase;
+  double time;
 
-  if (a < 0 && b < 0)
-    {
-      if (a == INT_MIN || b == INT_MIN)
-	return QUANTOR_OVERFLOW;
-      a = -a;
-      b = -b;
-      sign = -1;
-    }
-  else
-    sign = 1;
+  assert (!parser->parsing);
+  parser->parsing = 1;
+  prev_phase = enter_phase (quantor, QUANTOR_PHASE_PARSE);
 
-  if (a < b)
-    {
-      tmp = a;
-      a = b;
-      b = tmp;
-    }
+  init_default_scope (quantor);
 
-  res = a + b;
+  time = get_time ();
+#ifdef QUANTOR_LOG1
+  LOG (quantor, 1, "PARSING %s", quantor->io.in_name);
+#endif
+  assert (!count_IntStack (&quantor->external_scope));
+  assert (!count_IntStack (&quantor->external_literals));
+  assert (!parser->err);
 
-  if (res < a || (sign > 0 && res >= QUANTOR_OVERFLOW))
-    return QUANTOR_OVERFLOW;
+  assert (!quantor->stats.external_clauses);
+  assert (!quantor->stats.external_scopes);
+  assert (!quantor->stats.external_lits);
+  assert (!quantor->stats.external_vars);
 
-  res *= sign;
+  parser->lineno = 1;
+  parser->look_ahead = EOF;
 
-  assert (res < 0 || res < QUANTOR_OVERFLOW);
+  /* Input from 'quantor_parse_buffer' is already in memory.
+   */
+  if (quantor->io.in)
+    {
+      parser->buffer = new (quantor, QUANTOR_PARSE_BUFFER_SIZE);
+      parser->pos = parser->end = parser->buffer;
+    }
+  quantor->stats.specified_clauses = -1;
+  quantor->stats.specified_vars = -1;
+  max_idx = 0;
 
-  return res;
-}
+  assert (quantor->external_type == QUANTOR_UNDEFINED_TYPE);
 
-/*------------------------------------------------------------------------*/
+  while (!parser->err && (ch = get_char (quantor)) != EOF)
+    {
+      if (ch == 'c')
+	skip_line (quantor);
+      else if (ch == 'p')
+	{
+	  if (quantor->stats.specified_vars >= 0)
+	    parser->err = "multiple 'p' found";
+	  else if (scope_or_clause_not_closed (quantor) ||
+		   quantor->stats.external_clauses ||
+		   quantor->stats.external_scopes)
+	    parser->err = "misplaced 'p'";
+	  else if (!read_white_space (quantor) ||
+		   (get_char (quantor) != 'c') ||
+		   (get_char (quantor) != 'n') ||
+		   (get_char (quantor) != 'f') ||
+		   !read_white_space (quantor) ||
+		   !read_unsigned (quantor, ' ',
+				   &quantor->stats.specified_vars) ||
+		   !read_white_space (quantor) ||
+		   !read_unsigned (quantor, ' ',
+				   &quantor->stats.specified_clauses))
+	    parser->err = "malformend 'p cnf ...'";
+	}
+      else if (ch == '-' || isdigit (ch))
+	{
+	  if (ch == '-')
+	    {
+	      sign = -1;
+	      ch = get_char (quantor);
+	    }
+	  else
+	    sign = 1;
+
+	  if (!read_unsigned (quantor, ch, &lit))
+	    parser->err = "invalid literal";
+	  else
+	    {
+	      if (lit > max_idx)
+		max_idx = lit;
+
+	      lit *= sign;
+	      parser->err = quantor_add (quantor, lit);
+	    }
+	}
+      else if (ch == 'a' || ch == 'e')
+	parser->err = quantor_scope (quantor, char2qtype (ch));
+      else if (ch != ' ' && ch != '\t' && ch != '\n')
+	parser->err = "invalid character";
+    }
+
+  if (!parser->err && scope_or_clause_not_closed (quantor))
+    parser->err = "'0' missing";
+
+  if (!parser->err && quantor->stats.specified_vars < 0)
+    parser->err = "'p cnf ...' missing";
+
+  if (!parser->err && quantor->stats.specified_vars < max_idx)
+    parser->err = "more variables found than specified";
+
+  if (!parser->err &&
+      quantor->stats.specified_clauses != quantor->stats.external_clauses)
+    parser->err = "specified and actual number of clauses differ";
+
+  if (!parser->err)
+    {
+      /* TODO factor out this code */
+
+      register_proposed_zombies (quantor);
+      register_proposed_unates (quantor);
+      quantor->no_more_external_vars = 1;
+#ifdef QUANTOR_LOG4
+      LOG (quantor, 4, "EXPORTED %d VARIABLES", quantor->stats.num_exported);
+#endif
+#ifdef QUANTOR_LOG4
+      LOG (quantor, 4, "SCOPES AFTER PARSING:");
+#endif
+#ifdef QUANTOR_LOG1
+      log_scopes (quantor, 1);
+#endif
+    }
+
+  if (!quantor->stats.external_scopes)
+    {
+#ifdef QUANTOR_LOG1
+      LOG (quantor, 1, "INPUT IS PROPOSITIONAL (NO QUANTIFIERS)");
+#endif
+      register_propositional_original_problem (quantor);
+    }
+
+  if (!parser->err && 
+      quantor->stats.external_scopes &&
+      default_scope (quantor)->vars.len)
+    parser->err = "unquantified variable in QBF instance";
+
+  time = get_time () - time;
+  time = (time < 0) ? 0 : time;
+#ifdef QUANTOR_LOG1
+  LOG (quantor, 1, "PARSED %s", quantor->io.in_name);
+  LOG (quantor, 1, "  %d PARSED VARIABLES", quantor->stats.external_vars);
+  LOG (quantor, 1, "  %d PARSED CLAUSES", quantor->stats.external_clauses);
+  LOG (quantor, 1, "  %d PARSED LITERALS", quantor->stats.external_lits);
+  LOG (quantor, 1, "  %d PARSED SCOPES", quantor->stats.external_scopes);
+  LOG (quantor, 1, "PARSE TIME %.2f SECONDS", time);
+#endif
+
+  if (parser->buffer)
+    delete (quantor, parser->buffer, QUANTOR_PARSE_BUFFER_SIZE);
+
+  parser->buffer = 0;
+  parser->pos = parser->end = 0;
+
+  leave_phase (quantor, prev_phase);
+  assert (parser->parsing);
+  parser->parsing = 0;
+
+  return !parser->err;
+}
+
+/*------------------------------------------------------------------------*/
+
+const char *
+quantor_parse_buffer (Quantor * quantor, const char *buffer, size_t len)
+{
+  Parser *parser = &quantor->parser;
+  const char *saved_in_name;
+  FILE *saved_in;
+
+  if (quantor->scopes.first)
+    return "can not parse after adding scopes or clauses";
+
+  saved_in = quantor->io.in;
+  saved_in_name = quantor->io.in_name;
+  quantor->io.in = 0;
+  quantor->io.in_name = "<buffer>";
+
+  parser->pos = (const unsigned char *) buffer;
+  parser->end = parser->pos + len;
+
+  if (!parse (quantor))
+    sprintf (parser->err_buffer, "line %u: %s", parser->lineno, parser->err);
+
+  quantor->io.in = saved_in;
+  quantor->io.in_name = saved_in_name;
+
+  return parser->err ? parser->err_buffer : 0;
+}
+
+/*------------------------------------------------------------------------*/
+
+static int
+is_empty_Scope (Scope * scope)
+{
+  return !scope->vars.first;
+}
+
+/*------------------------------------------------------------------------*/
+
+static int
+is_propositional (Quantor * quantor)
+{
+  Scope *p;
+
+  if (quantor->invalid)
+    return 1;
+
+  for (p = quantor->scopes.first; p; p = p->link.next)
+    if (!is_empty_Scope (p) && p->type == QUANTOR_UNIVERSAL)
+      return 0;
+
+  return 1;
+}
+
+/*------------------------------------------------------------------------*/
+
+static int
+var_can_not_be_eliminated (Quantor * quantor, Var * var)
+{
+  if (var->eliminated)
+    return 1;
+
+  if (var->zombie)
+    return 1;
+
+  if (var->exported && !quantor->opts.resolve_exported)
+    return 1;
+
+  assert (!is_assigned_var (var));
+
+  return 0;
+}
+
+/*------------------------------------------------------------------------*/
+#ifdef QUANTOR_HAVE_DOUBLE_PRECISION_INT
+/*------------------------------------------------------------------------*/
+
+static int
+dpi2int (DPI dpi)
+{
+  if (dpi <= INT_MIN || dpi > QUANTOR_OVERFLOW)
+    return QUANTOR_OVERFLOW;
+  else
+    return (int) dpi;
+}
+
+/*------------------------------------------------------------------------*/
+
+static int
+mult_with_overflow (int a, int b)
+{
+  if (!a || !b)
+    return 0;
+
+  if (a >= QUANTOR_OVERFLOW || b >= QUANTOR_OVERFLOW)
+    return QUANTOR_OVERFLOW;
+
+  return dpi2int (((DPI) a) * ((DPI) b));
+}
+
+/*------------------------------------------------------------------------*/
+
+static int
+add_with_overflow (int a, int b)
+{
+  if (a >= QUANTOR_OVERFLOW || b >= QUANTOR_OVERFLOW)
+    return QUANTOR_OVERFLOW;
+
+  return dpi2int (((DPI) a) + ((DPI) b));
+}
+
+/*------------------------------------------------------------------------*/
+#else /* explicit saturating arithmetic without double precision int */
+/*------------------------------------------------------------------------*/
+
+static int
+ldfloor2 (int n)
+{
+  if (n & 2)
+    return 1;
+  else
+    return 0;
+}
+
+/*------------------------------------------------------------------------*/
+
+static int
+ldfloor4 (int n)
+{
+  if (n & 0xc)
+    return ldfloor2 (n >> 2) + 2;
+  else
+    return ldfloor2 (n);
+}
+
+/*------------------------------------------------------------------------*/
+
+static int
+ldfloor8 (int n)
+{
+  if (n & 0xf0)
+    return ldfloor4 (n >> 4) + 4;
+  else
+    return ldfloor4 (n);
+}
+
+/*------------------------------------------------------------------------*/
+
+static int
+ldfloor16 (int n)
+{
+  if (n & 0xff00)
+    return ldfloor8 (n >> 8) + 8;
+  else
+    return ldfloor8 (n);
+}
+
+/*------------------------------------------------------------------------*/
+
+static int
+ldfloor (int n)
+{
+  assert (n >= 0);
+
+  if (n & 0xffff0000)
+    return ldfloor16 (n >> 16) + 16;
+  else
+    return ldfloor16 (n);
+}
+
+/*------------------------------------------------------------------------*/
+/* Returns the number of bits necessary to represent the given number.
+ */
+static int
+num_bits (int n)
+{
+  assert (n >= 0);
+
+  return ldfloor (n) + 1;
+}
+
+/*------------------------------------------------------------------------*/
+/* We work with a special saturating arithmetic by adding a new value
+ * 'QUANTOR_OVERFLOW' which is a number slightly smaller than 'INT_MAX'.  The
+ * arithmetic is 'saturating' in the sense that adding or multiplying any
+ * value with 'QUANTOR_OVERFLOW' results in 'QUANTOR_OVERFLOW' as well.  In
+ * addition we make sure that any real overflow during addition or
+ * multiplication is detected and results in 'QUANTOR_OVERFLOW' to be returned.
+ */
+static int
+mult_with_overflow (int a, int b)
+{
+  int res, sign, tmp;
+
+  if (a == 0 || b == 0)
+    return 0;
+
+  if (a >= QUANTOR_OVERFLOW || b >= QUANTOR_OVERFLOW)
+    return QUANTOR_OVERFLOW;
+
+  if (a > b)
+    {
+      tmp = a;
+      a = b;
+      b = tmp;
+    }
+
+  if (b < 0)
+    {
+      assert (a < 0);
+
+      if (a == INT_MIN || b == INT_MIN)
+	return QUANTOR_OVERFLOW;
+
+      a = -a;
+      b = -b;
+      sign = 1;
+    }
+  else if (a < 0)
+    {
+      assert (b >= 0);
+
+      if (a == INT_MIN)
+	return QUANTOR_OVERFLOW;
+
+      sign = -1;
+      a = -a;
+    }
+  else
+    {
+      assert (a > 0 && b > 0);
+      sign = 1;
+    }
+
+  if (a > b)
+    {
+      tmp = a;
+      a = b;
+      b = tmp;
+    }
+
+  res = a * b;
+
+  if (a == 1 || (a == 2 && num_bits (b) <= 30 && res > 0) ||
+      (a > 2 && (num_bits (a) + num_bits (b) <= 31)))
+    {
+      assert (res > 0);
+
+      if (sign == -1)
+	res = -res;
+    }
+  else
+    res = QUANTOR_OVERFLOW;
+
+  if (res >= QUANTOR_OVERFLOW)
+    res = QUANTOR_OVERFLOW;
+
+  return res;
+}
+
+/*------------------------------------------------------------------------*/
+
+static int
+add_with_overflow (int a, int b)
+{
+  int sign, tmp, res;
+
+  if (a >= QUANTOR_OVERFLOW || b >= QUANTOR_OVERFLOW)
+    return QUANTOR_OVERFLOW;
+  else if ((a <= 0 && b >= 0) || (a >= 0 && b <= 0))
+    return a + b;
+
+  if (a < 0 && b < 0)
+    {
+      if (a == INT_MIN || b == INT_MIN)
+	return QUANTOR_OVERFLOW;
+      a = -a;
+      b = -b;
+      sign = -1;
+    }
+  else
+    sign = 1;
+
+  if (a < b)
+    {
+      tmp = a;
+      a = b;
+      b = tmp;
+    }
+
+  res = a + b;
+
+  if (res < a || (sign > 0 && res >= QUANTOR_OVERFLOW))
+    return QUANTOR_OVERFLOW;
+
+  res *= sign;
+
+  assert (res < 0 || res < QUANTOR_OVERFLOW);
+
+  return res;
+}
+
+/*------------------------------------------------------------------------*/
 #endif /* QUANTOR_HAVE_DOUBLE_PRECISION_INT */
 /*------------------------------------------------------------------------*/
 
-static int
-is_representative (Var * v)
+static int
+is_representative (Var * v)
+{
+  EquivalenceClass *ec;
+  int res;
+
+  ec = v->eqclass;
+  assert (ec);
+  assert (ec->representative);
+  res = (ec->representative == v);
+
+  return res;
+}
+
+/*------------------------------------------------------------------------*/
+/* This function computes an upper bound on the number of literals added if
+ * 'v' is eliminated by generating all resolvents on 'v' and removing all
+ * clauses in which 'v' occurs.  It is only an upper bound since some of the
+ * resolvents could be further simplified or may lead to the simplification
+ * of other clauses.  
+ *
+ * Let 's(l)' denote the sum of the number of literals of clauses in which
+ * 'l' occurs and 'o(l)' the number of occurences of 'l'.  As an abreviation
+ * use 'd(l) = s(l) - o(l)'.
+ *
+ * In the resulting clauses, obtained from resolving on all clauses in
+ * which 'v' resp. '-v' occurs, we have 'o(-v)' copies of the 'd(v)'
+ * literals from the clauses in which 'v' occured positively and 'o(v)'
+ * copies of the 'd(-v)' literals in which 'v' occured negatively.
+ *
+ *                     s(v)               s(-v)      
+ *                   literals            literals
+ *              .-------^-------.   .-------^-------.
+ *              +---------------+   +-----------+---+
+ *              |           | v |   |           |-v |
+ * o(v) clauses |           | : | x |           | : |  o(-v) clauses
+ *              |           | v |   |           |-v |
+ *              +-----------+---+   +-----------+---+
+ *              `-----v-----'       `-----v-----'
+ *           d(v) = s(v) - o(v)   d(-v) = s(-v) - o(-v)
+ *                literals            literals
+ */
+static int
+exists_resolve_all_score (Quantor * quantor, Var * v)
+{
+  int pos_delta, neg_delta, pos_lits, neg_lits, added, removed, res;
+  Lit *pos, *neg;
+
+  (void) quantor;
+
+  pos = var2lit (v, 0);
+  neg = var2lit (v, 1);
+
+  /* The sum of the number of literals in the clauses in which 'v' occurs
+   * positively resp. negatively without counting 'v' resp. '-v'.
+   */
+  pos_delta = pos->sum - pos->column.len;	/* d(v) */
+  neg_delta = neg->sum - neg->column.len;	/* d(-v) */
+
+  /* o(-v) * d(v)
+   */
+  pos_lits = mult_with_overflow (pos_delta, neg->column.len);
+
+  /* o(v) * d(-v)
+   */
+  neg_lits = mult_with_overflow (neg_delta, pos->column.len);
+
+  /* o(-v) * d(v) + o(v) * d(-v)
+   */
+  added = add_with_overflow (pos_lits, neg_lits);
+
+  /* s(v) + s(-v)
+   */
+  removed = add_with_overflow (pos->sum, neg->sum);
+
+  /* o(-v) * d(v) + o(v) * d(-v) - (s(v) + s(-v))
+   */
+  res = add_with_overflow (added, -removed);
+
+  /* Mark as being resolved by simple resolution of all clauses with 'v'.
+   */
+  v->cheapest_function_to_substitute = 0;
+
+  return res;
+}
+
+/*------------------------------------------------------------------------*/
+/* Find the four ternary clauses of an ITE or XOR function.  They may have
+ * been removed or strengthened since the function was extracted.
+ */
+static int
+find_gate_clauses (Quantor * quantor, Function * f, Clause ** clauses)
+{
+  Lit *x, *not_x, *a, *b, *c;
+  int i;
+
+  x = f->lhs;
+  not_x = QUANTOR_NOT (x);
+  a = f->rhs->literals[0];
+  b = f->rhs->literals[1];
+
+  if (f->type == QUANTOR_XOR_GATE)
+    {
+      clauses[0] = find_ternary_clause (quantor, not_x, a, b);
+      clauses[1] = find_ternary_clause (quantor, not_x,
+					QUANTOR_NOT (a), QUANTOR_NOT (b));
+      clauses[2] = find_ternary_clause (quantor, x, QUANTOR_NOT (a), b);
+      clauses[3] = find_ternary_clause (quantor, x, a, QUANTOR_NOT (b));
+    }
+  else
+    {
+      assert (f->type == QUANTOR_ITE_GATE);
+      c = f->rhs->literals[2];
+      clauses[0] = find_ternary_clause (quantor, not_x, QUANTOR_NOT (a), b);
+      clauses[1] = find_ternary_clause (quantor, x,
+					QUANTOR_NOT (a), QUANTOR_NOT (b));
+      clauses[2] = find_ternary_clause (quantor, not_x, a, c);
+      clauses[3] = find_ternary_clause (quantor, x, a, QUANTOR_NOT (c));
+    }
+
+  for (i = 0; i < 4; i++)
+    if (!clauses[i])
+      return 0;
+
+  return 1;
+}
+
+/*------------------------------------------------------------------------*/
+/* ITE and XOR gates both consist of two ternary clauses with the LHS 'l'
+ * and two with '-l'.  Each of the two gate clauses with 'l' is resolved
+ * with the 'o(-l) - 2' other clauses containing '-l'.  Each resolvent has
+ * the two other literals of the gate clause and all but one literal of the
+ * other clause, which sums up to
+ *
+ *   2 * ((s(-l) - 6) + (o(-l) - 2))
+ *
+ * added literals, and symmetrically for the gate clauses with '-l'.
+ */
+static int
+exists_gate_resolution_score (Quantor * quantor, Function * f)
+{
+  int added, removed, res, pos, neg;
+  Clause *gate_clauses[4];
+  Lit *not_l, *l;
+
+  if (!find_gate_clauses (quantor, f, gate_clauses))
+    return QUANTOR_OVERFLOW;
+
+  l = f->lhs;
+  not_l = QUANTOR_NOT (l);
+
+  pos = add_with_overflow (l->sum - 6, l->column.len - 2);
+  neg = add_with_overflow (not_l->sum - 6, not_l->column.len - 2);
+  added = mult_with_overflow (2, add_with_overflow (pos, neg));
+  removed = add_with_overflow (l->sum, not_l->sum);
+  res = add_with_overflow (added, 0 - removed);
+
+  return res;
+}
+
+/*------------------------------------------------------------------------*/
+/* In function resolution we replace the variable 'v' by substituting the
+ * RHS of a function with LHS 'l = v' or 'l = -v'.  This follows from
+ *     
+ *     exists x . (x = rhs & rest)  ==  rest [x := rhs]    (*)
+ *
+ * if 'x' does not occur in 'rhs'.  Assume we have extracted the following
+ * function of size 'n':
+ *   
+ *     l = l1 l2 ... ln
+ *
+ * WE USE JUXTAPOSITION TO DENOTE DISJUNCTION!
+ *
+ * Then the set of clauses in which 'v' or '-v' occurs can be partitioned in
+ * to four classes:
+ *
+ *   C1 -l                l -l1     l D1
+ *    :         C -l       :         :
+ *   Cm -l                l -ln     l Dk
+ *                      
+ *     P         Q         R         S
+ *
+ * The 'n+1' clauses in 'Q' and 'R' have been used to extract the function.
+ * In 'P' we collect the 'm' remaining clauses in which '-l' occurs and in
+ * 'S' the remaining 'k' clauses in which 'l' occurs.  
+ *
+ * Substitution now results in replacing 'l' in 'S' by 'C' and '-l' by '-C'
+ * in 'P'.  The first substitution simply results in:
+ *   
+ *   (C D1) & ... & (C Dk)     (**)
+ *   
+ * The latter substitution destroys the CNF, which can be fixed by
+ * applying the distributivity law as follows (i = 1..m):
+ *
+ *    Ci -C 
+ *    == 
+ *    Ci (-l1 & ... & -ln) 
+ *    ==
+ *    (Ci -l1) & ... & (Ci -ln)    (***)
+ *
+ * First note, that these 'n * m' clauses are exactly the resolvents in the
+ * resolution of the clauses in 'P' with the clauses in 'R' (or short 'P'
+ * with 'R').  Of course, the same applies to the 'k' clauses obtained
+ * substituting 'l' by 'C' in 'S'.  Here we simply resolve 'Q' with 'S'.
+ *
+ * The resolution of 'Q' with 'R' will only produce trivial clauses.  Thus,
+ * using function resolution following (*) first avoids generating the
+ * trivial clauses 'Q x R' and also does not need to add the clauses
+ * obtained by resolving 'P' with 'S'.  It will never produce more literals
+ * than ordinary elimination by resolution.
+ *
+ * Finally it is interesting to note that all of the potential resolvents
+ * between 'P' and 'S', which actually are not generated, are subsumed by
+ * the CNF obtained by function resolution:
+ *
+ * Resolving 'Ci -l' with 'l Dj' results in 'Ci Dj' which can be obtained
+ * in one hyper resolution step over the clauses
+ *
+ *    (Ci -l1) & ... & (Ci -ln) & (C Dj)
+ *
+ * and thus does not need to be added.
+ *
+ * To summarize, function resolution produces less clauses and literals and
+ * can be seen as ordinary variable elimination by resolution.
+ *
+ * In addition to the terminology defined for'exists_resolve_all_score' we
+ * use 's(P)' to denote the sum of literals in 'P' and 'o(P) = |P| = m' to
+ * denote the number of clauses in 'P' etc. and obtain:
+ *   
+ *   s(R) = 2*n             o(R) = n
+ *   s(Q) = n+1             o(Q) = 1
+ *   s(P) = s(-l) - (n+1)   o(P) = m = o(-l) - 1
+ *   s(S) = s(l) - 2*n      o(S) = k = o(l) - n
+ *
+ * The number of added literals by function resolution is the number of
+ * literals in 'P x R' in (***)
+ *   
+ *   n * s(P) = n * (s(-l) - (n+1))
+ *
+ * plus the number of literals in 'Q x S' in (**)
+ *   
+ *   s(S) + k * (n - 1) = s(l) - 2*n + (o(l) - n) * (n - 1)
+ *
+ * The number of removed literals is the same as above.
+ */
+static int
+exists_function_resolution_score_aux (Quantor * quantor, Function * f)
+{
+  int PR, QS, added, removed, res, PR1, n, QS1, QS2, ol;
+  Lit *not_l, *l;
+
+  if (f->type != QUANTOR_OR_GATE)
+    return exists_gate_resolution_score (quantor, f);
+
+  l = f->lhs;
+  ol = l->column.len;
+  not_l = QUANTOR_NOT (l);
+  n = f->rhs->size;
+
+  /* s(-l) - (n+1)
+   */
+  PR1 = add_with_overflow (not_l->sum, 0 - (n + 1));
+
+  /* n * (s(-l) - (n+1))
+   */
+  PR = mult_with_overflow (n, PR1);
+
+  /* s(l) - 2*n
+   */
+  QS1 = add_with_overflow (l->sum, 0 - 2 * n);
+
+  /* (o(l) - n) * (n - 1)
+   */
+  QS2 = mult_with_overflow (ol - n, n - 1);
+
+  /* s(l) - 2*n + (o(l) - n) * (n - 1)
+   */
+  QS = add_with_overflow (QS1, QS2);
+
+  added = add_with_overflow (PR, QS);
+  removed = add_with_overflow (l->sum, not_l->sum);
+  res = add_with_overflow (added, 0 - removed);
+
+  return res;
+}
+
+/*------------------------------------------------------------------------*/
+
+static int
+exists_function_resolution_score (Quantor * quantor, Var * v)
+{
+  Function *p;
+  int res, tmp;
+
+  assert (v->functions.first);
+  res = QUANTOR_OVERFLOW;
+  v->cheapest_function_to_substitute = 0;
+
+  for (p = v->functions.first; p; p = p->lhs_link.next)
+    {
+      tmp = exists_function_resolution_score_aux (quantor, p);
+      if (tmp < res)
+	{
+	  v->cheapest_function_to_substitute = p;
+	  res = tmp;
+	}
+    }
+
+  return res;
+}
+
+/*------------------------------------------------------------------------*/
+
+/* Upper bound on the number of literals added by eliminating 'v'.  This
+ * also selects the function to substitute in 'exists'.
+ */
+static int
+exists_cost (Quantor * quantor, Var * v)
+{
+  int res;
+
+  if (quantor->opts.function_resolution && v->functions.first)
+    {
+      res = exists_function_resolution_score (quantor, v);
+      if (!v->cheapest_function_to_substitute)
+	res = exists_resolve_all_score (quantor, v);
+    }
+  else
+    res = exists_resolve_all_score (quantor, v);
+
+  return res;
+}
+
+/*------------------------------------------------------------------------*/
+
+static int
+min_degree_score (Quantor * quantor, Var * v)
+{
+  Lit *pos, *neg;
+
+  (void) quantor;
+
+  pos = var2lit (v, 0);
+  neg = var2lit (v, 1);
+
+  return add_with_overflow (pos->column.len, neg->column.len);
+}
+
+/*------------------------------------------------------------------------*/
+/* Number of clauses added by eliminating 'v', counting all resolvents.
+ */
+static int
+min_fill_score (Quantor * quantor, Var * v)
+{
+  int resolvents, removed;
+  Lit *pos, *neg;
+
+  (void) quantor;
+
+  pos = var2lit (v, 0);
+  neg = var2lit (v, 1);
+
+  resolvents = mult_with_overflow (pos->column.len, neg->column.len);
+  removed = add_with_overflow (pos->column.len, neg->column.len);
+
+  return add_with_overflow (resolvents, 0 - removed);
+}
+
+/*------------------------------------------------------------------------*/
+/* Variables are created in the order of the quantifier prefix, thus the
+ * variable of a scope which occurs first in the prefix is eliminated
+ * first.  Internal variables, such as copies made by 'forall', come last.
+ */
+static int
+prefix_score (Quantor * quantor, Var * v)
+{
+  (void) quantor;
+  return v->position;
+}
+
+/*------------------------------------------------------------------------*/
+/* The strategy only defines the order of the existential variables within
+ * a scope.  The expected costs, which decide between 'exists' and
+ * 'forall', are always computed by 'exists_cost'.
+ */
+typedef struct Strategy Strategy;
+
+struct Strategy
+{
+  const char *name;
+  int (*score) (Quantor *, Var *);
+};
+
+static Strategy strategies[QUANTOR_NUM_STRATEGIES] = {
+  {"default", exists_cost},
+  {"min-degree", min_degree_score},
+  {"min-fill", min_fill_score},
+  {"prefix", prefix_score},
+};
+
+/*------------------------------------------------------------------------*/
+
+static Strategy *
+get_strategy (Quantor * quantor)
+{
+  assert (0 <= quantor->opts.strategy);
+  assert (quantor->opts.strategy < QUANTOR_NUM_STRATEGIES);
+  return strategies + quantor->opts.strategy;
+}
+
+/*------------------------------------------------------------------------*/
+
+static int
+exists_score (Quantor * quantor, Var * v)
+{
+  if (is_assigned_var (v))
+    return QUANTOR_ASSIGNED_SCORE;
+
+  if (v->eqclass && !is_representative (v))
+    return QUANTOR_NONREPRESENTATIVE_SCORE;
+
+  if (var_can_not_be_eliminated (quantor, v))
+    return QUANTOR_STICKY_SCORE;
+
+  return get_strategy (quantor)->score (quantor, v);
+}
+
+/*------------------------------------------------------------------------*/
+
+static int
+forall_score (Quantor * quantor, Var * v)
+{
+  int res, sum, len;
+  Lit *neg, *pos;
+
+  (void) quantor;
+
+  assert (!is_assigned_var (v));
+  assert (!var_can_not_be_eliminated (quantor, v));
+
+  pos = var2lit (v, 0);
+  neg = var2lit (v, 1);
+  len = add_with_overflow (0 - pos->column.len, 0 - neg->column.len);
+  sum = add_with_overflow (0 - pos->sum, 0 - neg->sum);
+  res = add_with_overflow (len, sum);
+
+  return res;
+}
+
+/*------------------------------------------------------------------------*/
+
+static int
+reorder_var (Quantor * quantor, Var * v)
+{
+  int old_score, new_score, old_order;
+  Scope *scope;
+
+  INCSTATS2 (quantor->stats.reordered);
+
+  old_score = v->score;
+  scope = v->scope;
+  (void) old_score;
+
+  assert (scope);
+  assert (is_linked (&scope->reorder.first, v, &v->reorder_link));
+
+  if (scope->type == QUANTOR_EXISTENTIAL)
+    new_score = exists_score (quantor, v);
+  else
+    new_score = forall_score (quantor, v);
+
+  undlink (&scope->reorder.first, v, &v->reorder_link);
+
+  if (old_score == new_score)
+    return 0;
+
+  v->score = new_score;
+#ifdef QUANTOR_LOG8
+  LOG (quantor, 8,
+       "UPDATED VARIABLE %d WITH NEW SCORE %s",
+       v->idx, score2str (quantor, new_score));
+#endif
+
+  old_order = v->rank;
+  (void) old_order;
+  fix_order (quantor, &scope->order, v->rank);
+
+#ifdef QUANTOR_LOG8
+  if (old_order != v->rank)
+    LOG (quantor, 8, "REORDERED VARIABLE %d FROM %d TO %d",
+	 v->idx, old_order, v->rank);
+#endif
+
+  return 1;
+}
+
+/*------------------------------------------------------------------------*/
+
+static unsigned
+reorder_scope (Quantor * quantor, Scope * scope)
+{
+  unsigned count;
+  Var *v;
+
+  count = 0;
+  while ((v = scope->reorder.first))
+    count += reorder_var (quantor, v);
+
+#ifdef QUANTOR_LOG5
+  if (count)
+    LOG (quantor, 7, "REORDERED %d VARIABLES IN SCOPE %s",
+	 count, scope2str (quantor, scope));
+#endif
+
+  return count;
+}
+
+/*------------------------------------------------------------------------*/
+
+static Scope *
+prev_non_empty_scope (Scope * scope)
+{
+  Scope *res;
+
+  for (res = scope ? scope->link.prev : 0;
+       res && is_empty_Scope (res); res = res->link.prev)
+    ;
+
+  return res;
+}
+
+/*------------------------------------------------------------------------*/
+
+static Scope *
+next_non_empty_scope (Scope * scope)
 {
-  EquivalenceClass *ec;
-  int res;
+  Scope *res;
 
-  ec = v->eqclass;
-  assert (ec);
-  assert (ec->representative);
-  res = (ec->representative == v);
+  for (res = scope ? scope->link.next : 0;
+       res && is_empty_Scope (res); res = res->link.next)
+    ;
 
   return res;
 }
 
 /*------------------------------------------------------------------------*/
-/* This function computes an upper bound on the number of literals added if
- * 'v' is eliminated by generating all resolvents on 'v' and removing all
- * clauses in which 'v' occurs.  It is only an upper bound since some of the
- * resolvents could be further simplified or may lead to the simplification
- * of other clauses.  
- *
- * Let 's(l)' denote the sum of the number of literals of clauses in which
- * 'l' occurs and 'o(l)' the number of occurences of 'l'.  As an abreviation
- * use 'd(l) = s(l) - o(l)'.
- *
- * In the resulting clauses, obtained from resolving on all clauses in
- * which 'v' resp. '-v' occurs, we have 'o(-v)' copies of the 'd(v)'
- * literals from the clauses in which 'v' occured positively and 'o(v)'
- * copies of the 'd(-v)' literals in which 'v' occured negatively.
- *
- *                     s(v)               s(-v)      
- *                   literals            literals
- *              .-------^-------.   .-------^-------.
- *              +---------------+   +-----------+---+
- *              |           | v |   |           |-v |
- * o(v) clauses |           | : | x |           | : |  o(-v) clauses
- *              |           | v |   |           |-v |
- *              +-----------+---+   +-----------+---+
- *              `-----v-----'       `-----v-----'
- *           d(v) = s(v) - o(v)   d(-v) = s(-v) - o(-v)
- *                literals            literals
- */
-static int
-exists_resolve_all_score (Quantor * quantor, Var * v)
+
+static Scope *
+last_non_empty_existential_scope (Quantor * quantor)
 {
-  int pos_delta, neg_delta, pos_lits, neg_lits, added, removed, res;
-  Lit *pos, *neg;
+  Scope *res;
 
-  (void) quantor;
+  res = quantor->scopes.last;
+  if (res && is_empty_Scope (res))
+    res = prev_non_empty_scope (res);
 
-  pos = var2lit (v, 0);
-  neg = var2lit (v, 1);
+  assert (!res || res->type == QUANTOR_EXISTENTIAL);
 
-  /* The sum of the number of literals in the clauses in which 'v' occurs
-   * positively resp. negatively without counting 'v' resp. '-v'.
-   */
-  pos_delta = pos->sum - pos->column.len;	/* d(v) */
-  neg_delta = neg->sum - neg->column.len;	/* d(-v) */
+  return res;
+}
 
-  /* o(-v) * d(v)
-   */
-  pos_lits = mult_with_overflow (pos_delta, neg->column.len);
+/*------------------------------------------------------------------------*/
 
-  /* o(v) * d(-v)
-   */
-  neg_lits = mult_with_overflow (neg_delta, pos->column.len);
+static Scope *
+first_non_empty_innermost_existential_scope (Quantor * quantor)
+{
+  Scope *res, *prev;
 
-  /* o(-v) * d(v) + o(v) * d(-v)
-   */
-  added = add_with_overflow (pos_lits, neg_lits);
+  res = last_non_empty_existential_scope (quantor);
+  prev = prev_non_empty_scope (res);
 
-  /* s(v) + s(-v)
-   */
-  removed = add_with_overflow (pos->sum, neg->sum);
+  while (prev && prev->type == QUANTOR_EXISTENTIAL)
+    {
+      res = prev;
+      prev = prev_non_empty_scope (res);
+    }
 
-  /* o(-v) * d(v) + o(v) * d(-v) - (s(v) + s(-v))
-   */
-  res = add_with_overflow (added, -removed);
+  return res;
+}
 
-  /* Mark as being resolved by simple resolution of all clauses with 'v'.
-   */
-  v->cheapest_function_to_substitute = 0;
+/*------------------------------------------------------------------------*/
+
+static Scope *
+first_non_empty_scope (Quantor * quantor)
+{
+  Scope *res;
+
+  for (res = quantor->scopes.first;
+       res && is_empty_Scope (res); res = res->link.next)
+    ;
 
   return res;
 }
 
 /*------------------------------------------------------------------------*/
-/* In function resolution we replace the variable 'v' by substituting the
- * RHS of a function with LHS 'l = v' or 'l = -v'.  This follows from
- *     
- *     exists x . (x = rhs & rest)  ==  rest [x := rhs]    (*)
- *
- * if 'x' does not occur in 'rhs'.  Assume we have extracted the following
- * function of size 'n':
- *   
- *     l = l1 l2 ... ln
- *
- * WE USE JUXTAPOSITION TO DENOTE DISJUNCTION!
- *
- * Then the set of clauses in which 'v' or '-v' occurs can be partitioned in
- * to four classes:
- *
- *   C1 -l                l -l1     l D1
- *    :         C -l       :         :
- *   Cm -l                l -ln     l Dk
- *                      
- *     P         Q         R         S
- *
- * The 'n+1' clauses in 'Q' and 'R' have been used to extract the function.
- * In 'P' we collect the 'm' remaining clauses in which '-l' occurs and in
- * 'S' the remaining 'k' clauses in which 'l' occurs.  
- *
- * Substitution now results in replacing 'l' in 'S' by 'C' and '-l' by '-C'
- * in 'P'.  The first substitution simply results in:
- *   
- *   (C D1) & ... & (C Dk)     (**)
- *   
- * The latter substitution destroys the CNF, which can be fixed by
- * applying the distributivity law as follows (i = 1..m):
- *
- *    Ci -C 
- *    == 
- *    Ci (-l1 & ... & -ln) 
- *    ==
- *    (Ci -l1) & ... & (Ci -ln)    (***)
- *
- * First note, that these 'n * m' clauses are exactly the resolvents in the
- * resolution of the clauses in 'P' with the clauses in 'R' (or short 'P'
- * with 'R').  Of course, the same applies to the 'k' clauses obtained
- * substituting 'l' by 'C' in 'S'.  Here we simply resolve 'Q' with 'S'.
- *
- * The resolution of 'Q' with 'R' will only produce trivial clauses.  Thus,
- * using function resolution following (*) first avoids generating the
- * trivial clauses 'Q x R' and also does not need to add the clauses
- * obtained by resolving 'P' with 'S'.  It will never produce more literals
- * than ordinary elimination by resolution.
- *
- * Finally it is interesting to note that all of the potential resolvents
- * between 'P' and 'S', which actually are not generated, are subsumed by
- * the CNF obtained by function resolution:
- *
- * Resolving 'Ci -l' with 'l Dj' results in 'Ci Dj' which can be obtained
- * in one hyper resolution step over the clauses
- *
- *    (Ci -l1) & ... & (Ci -ln) & (C Dj)
- *
- * and thus does not need to be added.
- *
- * To summarize, function resolution produces less clauses and literals and
- * can be seen as ordinary variable elimination by resolution.
- *
- * In addition to the terminology defined for'exists_resolve_all_score' we
- * use 's(P)' to denote the sum of literals in 'P' and 'o(P) = |P| = m' to
- * denote the number of clauses in 'P' etc. and obtain:
- *   
- *   s(R) = 2*n             o(R) = n
- *   s(Q) = n+1             o(Q) = 1
- *   s(P) = s(-l) - (n+1)   o(P) = m = o(-l) - 1
- *   s(S) = s(l) - 2*n      o(S) = k = o(l) - n
- *
- * The number of added literals by function resolution is the number of
- * literals in 'P x R' in (***)
- *   
- *   n * s(P) = n * (s(-l) - (n+1))
- *
- * plus the number of literals in 'Q x S' in (**)
- *   
- *   s(S) + k * (n - 1) = s(l) - 2*n + (o(l) - n) * (n - 1)
- *
- * The number of removed literals is the same as above.
- */
+
 static int
-exists_function_resolution_score_aux (Quantor * quantor, Function * f)
+literals_per_clause_limit_exceeded (Quantor * quantor, int existential_cost)
 {
-  int PR, QS, added, removed, res, PR1, n, QS1, QS2, ol;
-  Lit *not_l, *l;
+  int sum, res, len;
+  Scope *scope;
+  double ratio;
 
-  (void) quantor;
+  scope = first_non_empty_innermost_existential_scope (quantor);
+  sum = existential_cost;
+  len = 0;
+  while (scope)
+    {
+      sum += scope->sum;
+      len += scope->clauses.len;
+      scope = scope->link.next;
+    }
+  assert (len > 0);
+  ratio = sum / (double) len;
+#ifdef QUANTOR_LOG5
+  LOG (quantor, 5, "NEW RATIO AFTER EXISTS WOULD BE %.1f", ratio);
+#endif
+  res = (ratio >= quantor->opts.literals_per_clause_limit);
 
-  l = f->lhs;
-  ol = l->column.len;
-  not_l = QUANTOR_NOT (l);
-  n = f->rhs->size;
+  return res;
+}
 
-  /* s(-l) - (n+1)
-   */
-  PR1 = add_with_overflow (not_l->sum, 0 - (n + 1));
+/*------------------------------------------------------------------------*/
+#ifndef NDEBUG
+/*------------------------------------------------------------------------*/
 
-  /* n * (s(-l) - (n+1))
-   */
-  PR = mult_with_overflow (n, PR1);
+static void
+check_basically_simplified (Quantor * quantor)
+{
+  assert (!quantor->units.first);
+  assert (!quantor->unates.first);
+  assert (!quantor->dying_clauses.first);
+}
+
+/*------------------------------------------------------------------------*/
+#endif
+/*------------------------------------------------------------------------*/
+
+static Var *
+cheapest_existential (Quantor * quantor, int *cost_ptr, const char *msg)
+{
+  Var *res, *tmp;
+  Scope *p;
+
+  res = 0;
+  for (p = quantor->scopes.last; p; p = p->link.prev)
+    {
+      if (is_empty_Scope (p))
+	continue;
 
-  /* s(l) - 2*n
-   */
-  QS1 = add_with_overflow (l->sum, 0 - 2 * n);
+      if (p->type == QUANTOR_UNIVERSAL)
+	break;
 
-  /* (o(l) - n) * (n - 1)
-   */
-  QS2 = mult_with_overflow (ol - n, n - 1);
+      reorder_scope (quantor, p);
+      assert (count_PtrStack (&p->order) > 0);
+      tmp = p->order.start[0];
+      if (!res || res->score > tmp->score)
+	res = tmp;
+    }
 
-  /* s(l) - 2*n + (o(l) - n) * (n - 1)
-   */
-  QS = add_with_overflow (QS1, QS2);
+  assert (res);
 
-  added = add_with_overflow (PR, QS);
-  removed = add_with_overflow (l->sum, not_l->sum);
-  res = add_with_overflow (added, 0 - removed);
+  /* Special scores are kept as costs to prevent elimination.
+   */
+  if (quantor->opts.strategy && res->score <= QUANTOR_OVERFLOW)
+    *cost_ptr = exists_cost (quantor, res);
+  else
+    *cost_ptr = res->score;
+#ifdef QUANTOR_LOG4
+  LOG (quantor, 4,
+       "CHEAPEST %s VARIABLE %d HAS EXPECTED COST OF %s",
+       msg, res->idx, score2str (quantor, *cost_ptr));
+#else
+  (void) msg;
+#endif
 
   return res;
 }
 
 /*------------------------------------------------------------------------*/
 
-static int
-exists_function_resolution_score (Quantor * quantor, Var * v)
+static Var *
+cheapest_universal (Quantor * quantor, int *cost_ptr)
 {
-  Function *p;
-  int res, tmp;
+  int cost, min_cost, removed, added;
+  Scope *p, *existential_scope;
+  Var *res, *tmp;
 
-  assert (v->functions.first);
-  res = QUANTOR_OVERFLOW;
+  existential_scope = first_non_empty_innermost_existential_scope (quantor);
 
-  for (p = v->functions.first; p; p = p->lhs_link.next)
+  added = 0;
+  for (p = existential_scope; p; p = p->link.next)
+    added += p->sum;
+
+  res = 0;
+  min_cost = INT_MAX;
+
+  for (p = existential_scope->link.prev; p; p = p->link.prev)
     {
-      tmp = exists_function_resolution_score_aux (quantor, p);
-      if (tmp < res)
+      if (is_empty_Scope (p))
+	continue;
+
+      if (p->type == QUANTOR_EXISTENTIAL)
+	break;
+
+      reorder_scope (quantor, p);
+      assert (count_PtrStack (&p->order) > 0);
+      tmp = p->order.start[0];
+      removed = tmp->score;
+      assert (removed == QUANTOR_OVERFLOW || removed < 0);
+      cost = add_with_overflow (removed, added);
+      if (!res || min_cost > cost)
 	{
-	  v->cheapest_function_to_substitute = p;
 	  res = tmp;
+	  min_cost = cost;
 	}
     }
 
+  assert (res);
+#ifdef QUANTOR_LOG4
+  LOG (quantor, 4,
+       "CHEAPEST INNER UNIVERSAL VARIABLE %d HAS EXPECTED COST OF %s",
+       res->idx, score2str (quantor, min_cost));
+#endif
+  *cost_ptr = min_cost;
+
   return res;
 }
 
 /*------------------------------------------------------------------------*/
 
 static int
-exists_score (Quantor * quantor, Var * v)
+reached_hard_exists_limit (Quantor * quantor, int cost)
 {
-  int res;
+  if (cost < quantor->opts.hard_exists_limit)
+    return 0;
 
-  if (is_assigned_var (v))
-    return QUANTOR_ASSIGNED_SCORE;
+#ifdef QUANTOR_LOG4
+  LOG (quantor, 4, "COST %d REACHED HARD EXISTS LIMIT %d",
+       cost, quantor->opts.hard_exists_limit);
+#endif
 
-  if (v->eqclass && !is_representative (v))
-    return QUANTOR_NONREPRESENTATIVE_SCORE;
+  return 1;
+}
 
-  if (var_can_not_be_eliminated (quantor, v))
-    return QUANTOR_STICKY_SCORE;
+/*------------------------------------------------------------------------*/
 
-  if (quantor->opts.function_resolution && v->functions.first)
-    res = exists_function_resolution_score (quantor, v);
+static int
+reached_soft_exists_limit (Quantor * quantor, int cost)
+{
+  int i, res, len, *literals;
+  double sum, avg;
+
+  sum = cost;
+  len = quantor->opts.soft_exists_length;
+  literals = quantor->opts.literals_added_by_exists;
+
+  for (i = 0; i < len; i++)
+    sum += literals[i];
+
+  assert (len >= 0);
+  avg = sum / (double) (len + 1);
+
+#ifdef QUANTOR_LOG4
+  LOG (quantor, 4, "AVERAGE LAST %d EXIST COSTS IS %.2f", len, avg);
+#endif
+
+  if (avg >= (double) quantor->opts.soft_exists_limit)
+    {
+#ifdef QUANTOR_LOG4
+      LOG (quantor, 4, "SOFT EXIST LIMIT %d REACHED",
+	   quantor->opts.soft_exists_limit);
+#endif
+      res = 1;
+    }
   else
-    res = exists_resolve_all_score (quantor, v);
+    res = 0;
 
   return res;
 }
 
 /*------------------------------------------------------------------------*/
 
-static int
-forall_score (Quantor * quantor, Var * v)
+static void
+save_actual_exists_costs (Quantor * quantor, int actual_cost)
 {
-  int res, sum, len;
-  Lit *neg, *pos;
+  int i, len, *literals;
 
-  (void) quantor;
+  len = quantor->opts.soft_exists_length;
+  if (len <= 0)
+    return;
 
-  assert (!is_assigned_var (v));
-  assert (!var_can_not_be_eliminated (quantor, v));
+  literals = quantor->opts.literals_added_by_exists;
 
-  pos = var2lit (v, 0);
-  neg = var2lit (v, 1);
-  len = add_with_overflow (0 - pos->column.len, 0 - neg->column.len);
-  sum = add_with_overflow (0 - pos->sum, 0 - neg->sum);
-  res = add_with_overflow (len, sum);
+  for (i = 1; i < len; i++)
+    literals[i - 1] = literals[i];
 
-  return res;
+  literals[len - 1] = actual_cost;
 }
 
 /*------------------------------------------------------------------------*/
 
 static int
-reorder_var (Quantor * quantor, Var * v)
+reached_exists_limit (Quantor * quantor, int cost)
 {
-  int old_score, new_score, old_order;
-  Scope *scope;
-
-  INCSTATS2 (quantor->stats.reordered);
+  if (reached_hard_exists_limit (quantor, cost))
+    return 1;
 
-  old_score = v->score;
-  scope = v->scope;
-  (void) old_score;
+  if (reached_soft_exists_limit (quantor, cost))
+    return 1;
 
-  assert (scope);
-  assert (is_linked (&scope->reorder.first, v, &v->reorder_link));
+  return 0;
+}
 
-  if (scope->type == QUANTOR_EXISTENTIAL)
-    new_score = exists_score (quantor, v);
-  else
-    new_score = forall_score (quantor, v);
+/*------------------------------------------------------------------------*/
 
-  undlink (&scope->reorder.first, v, &v->reorder_link);
+static Var *
+pivot (Quantor * quantor, int *expected_cost_ptr)
+{
+  int existential_cost, universal_cost, choose_universal;
+  Var *res, *existential_var, *universal_var;
+  double biased_cost;
 
-  if (old_score == new_score)
+#ifndef NDEBUG
+  check_basically_simplified (quantor);
+#endif
+  if (!quantor->opts.exists && !quantor->opts.forall)
     return 0;
 
-  v->score = new_score;
-#ifdef QUANTOR_LOG8
-  LOG (quantor, 8,
-       "UPDATED VARIABLE %d WITH NEW SCORE %s",
-       v->idx, score2str (quantor, new_score));
-#endif
+  existential_cost = universal_cost = 0;
+  existential_var = universal_var = 0;
 
-  old_order = v->rank;
-  (void) old_order;
-  fix_order (quantor, &scope->order, v->rank);
+  if (quantor->opts.exists)
+    existential_var =
+      cheapest_existential (quantor, &existential_cost, "INNER EXISTENTIAL");
 
-#ifdef QUANTOR_LOG8
-  if (old_order != v->rank)
-    LOG (quantor, 8, "REORDERED VARIABLE %d FROM %d TO %d",
-	 v->idx, old_order, v->rank);
+  if (quantor->opts.exists && !quantor->opts.forall)
+    {
+#ifdef QUANTOR_LOG5
+      LOG (quantor, 5, "CHOOSING EXIST SINCE FORALL IS DISABLED");
+#endif
+      choose_universal = 0;
+    }
+  else if (quantor->opts.exists &&
+	   !reached_exists_limit (quantor, existential_cost))
+    {
+      INCSTATS2 (quantor->stats.smaller_exists_limit);
+#ifdef QUANTOR_LOG5
+      LOG (quantor, 5, "EXISTENTIAL COST IS BELOW EXISTS LIMIT");
+#endif
+      choose_universal = 0;
+    }
+  else
+    {
+      assert (quantor->opts.forall);
+      universal_var = cheapest_universal (quantor, &universal_cost);
+      if (!quantor->opts.exists)
+	{
+	  choose_universal = 1;
+	}
+      else if (quantor->opts.exists &&
+	       literals_per_clause_limit_exceeded (quantor, existential_cost))
+	{
+#ifdef QUANTOR_LOG5
+	  LOG (quantor, 5, "EXISTS WOULD EXCEED LITERALS PER CLAUSE RATIO");
+#endif
+	  INCSTATS2 (quantor->stats.literals_per_clause_limit_exceeded);
+	  quantor->opts.literals_per_clause_limit *=
+	    quantor->opts.literals_per_clause_factor;
+	  choose_universal = 1;
+	}
+      else
+	{
+	  biased_cost = quantor->opts.forall_bias * existential_cost;
+	  choose_universal = (universal_cost <= biased_cost);
+#ifdef QUANTOR_LOG5
+	  LOG (quantor, 5,
+	       "UNIVERSAL COST %d %s BIASED EXISTENTIAL COST %.0f",
+	       universal_cost, choose_universal ? "<=" : ">", biased_cost);
 #endif
+	}
+    }
+
+  if (choose_universal)
+    {
+      assert (universal_var);
+      *expected_cost_ptr = universal_cost;
+      res = universal_var;
+    }
+  else
+    {
+      assert (existential_var);
+      *expected_cost_ptr = existential_cost;
+      res = existential_var;
+    }
 
-  return 1;
+  return res;
 }
 
 /*------------------------------------------------------------------------*/
 
-static unsigned
-reorder_scope (Quantor * quantor, Scope * scope)
+static void
+add_literals_of_clause_except (Quantor * quantor, Clause * c, Var * v)
 {
-  unsigned count;
-  Var *v;
+  Lit *pos, *neg, *lit;
+  Cell *p, *eor;
+#ifndef NDEBUG
+  Lit *found = 0;
+#endif
 
-  count = 0;
-  while ((v = scope->reorder.first))
-    count += reorder_var (quantor, v);
+  pos = v->lits;
+  neg = pos + 1;
 
-#ifdef QUANTOR_LOG5
-  if (count)
-    LOG (quantor, 7, "REORDERED %d VARIABLES IN SCOPE %s",
-	 count, scope2str (quantor, scope));
+  eor = end_of_row (c);
+  for (p = c->row; p < eor; p++)
+    {
+      lit = p->lit;
+
+      if (lit == pos || lit == neg)
+	{
+#ifndef NDEBUG
+	  assert (!found);
+	  found = lit;
 #endif
+	}
+      else
+	push_PtrStack (quantor, &quantor->new_clause, lit);
+    }
 
-  return count;
+  assert (found);
 }
 
 /*------------------------------------------------------------------------*/
 
-static Scope *
-prev_non_empty_scope (Scope * scope)
+static void
+resolve (Quantor * quantor, Var * v, Clause * c, Clause * d)
 {
-  Scope *res;
-
-  for (res = scope ? scope->link.prev : 0;
-       res && is_empty_Scope (res); res = res->link.prev)
-    ;
-
-  return res;
+#ifdef QUANTOR_LOG6
+  LOG (quantor, 6, "RESOLVING CLAUSE %d AND CLAUSE %d ON %d",
+       c->idx, d->idx, v->idx);
+#endif
+  assert (!count_PtrStack (&quantor->new_clause));
+  add_literals_of_clause_except (quantor, c, v);
+  add_literals_of_clause_except (quantor, d, v);
+  add_new_clause (quantor, "RESOLVED");
 }
 
 /*------------------------------------------------------------------------*/
 
-static Scope *
-next_non_empty_scope (Scope * scope)
+static void
+resolve_all_clauses_with (Quantor * quantor, Var * v)
 {
-  Scope *res;
+  Clause **q, **end;
+  Lit *neg, *pos;
+  Cell *p;
 
-  for (res = scope ? scope->link.next : 0;
-       res && is_empty_Scope (res); res = res->link.next)
-    ;
+  pos = var2lit (v, 0);
+  neg = var2lit (v, 1);
 
-  return res;
+  /* The inner loop runs over a compact copy of the negative occurrences
+   * instead of following the column links once for every positive
+   * occurrence.  Killed clauses stay in their columns until the next
+   * 'gc', so the columns do not change while resolving.
+   */
+  assert (!count_PtrStack (&quantor->occurrences));
+  for (p = neg->column.first; p; p = p->column_link.next)
+    push_PtrStack (quantor, &quantor->occurrences, p->clause);
+
+  /* Resolvents are added one after the other, for the same reason as
+   * clauses are copied sequentially in 'forall'.
+   */
+  end = (Clause **) quantor->occurrences.top;
+  for (p = pos->column.first; p; p = p->column_link.next)
+    for (q = (Clause **) quantor->occurrences.start; q < end; q++)
+      resolve (quantor, v, p->clause, *q);
+
+  reset_PtrStack (quantor, &quantor->occurrences, 0);
 }
 
 /*------------------------------------------------------------------------*/
 
-static Scope *
-last_non_empty_existential_scope (Quantor * quantor)
+static void
+remove_all_clauses_with (Quantor * quantor, Lit * lit)
 {
-  Scope *res;
-
-  res = quantor->scopes.last;
-  if (res && is_empty_Scope (res))
-    res = prev_non_empty_scope (res);
-
-  assert (!res || res->type == QUANTOR_EXISTENTIAL);
+  Cell *p, *next;
 
-  return res;
+  for (p = lit->column.first; p; p = next)
+    {
+      next = p->column_link.next;
+      kill_Clause (quantor, p->clause);
+    }
 }
 
 /*------------------------------------------------------------------------*/
 
-static Scope *
-first_non_empty_innermost_existential_scope (Quantor * quantor)
+static void
+mark_clauses_of_substituted_function (Quantor * quantor,
+				      Function * f, int new_mark)
 {
-  Scope *res, *prev;
+  Clause *clause, *binary_clause;
+  Lit *lit, *not_lit, *lhs;
+  Cell *p, *eor;
+  int found_lhs;
 
-  res = last_non_empty_existential_scope (quantor);
-  prev = prev_non_empty_scope (res);
+  lhs = f->lhs;
+  clause = f->clause;
+  assert (clause->part_of_substituted_function != new_mark);
+  clause->part_of_substituted_function = new_mark;
 
-  while (prev && prev->type == QUANTOR_EXISTENTIAL)
+  found_lhs = 0;
+  (void) found_lhs;
+  eor = end_of_row (clause);
+  for (p = clause->row; p < eor; p++)
     {
-      res = prev;
-      prev = prev_non_empty_scope (res);
+      lit = p->lit;
+      not_lit = QUANTOR_NOT (lit);
+      if (not_lit == lhs)
+	{
+	  found_lhs = 1;
+	  continue;
+	}
+
+      binary_clause = find_binary_clause (quantor, lhs, not_lit);
+      assert (binary_clause);
+      assert (binary_clause->part_of_substituted_function == !new_mark);
+      binary_clause->part_of_substituted_function = new_mark;
     }
 
-  return res;
+  assert (found_lhs);
 }
 
 /*------------------------------------------------------------------------*/
-
-static Scope *
-first_non_empty_scope (Quantor * quantor)
+/* Returns zero if the clauses of the function are not all present anymore.
+ * Then all clauses have to be resolved.
+ */
+static int
+substitute_cheapest_function (Quantor * quantor, Var * v)
 {
-  Scope *res;
+  Clause *a, *b, *gate_clauses[4];
+  Lit *neg, *pos;
+  Function *f;
+  Cell *p, *q;
+  int i;
 
-  for (res = quantor->scopes.first;
-       res && is_empty_Scope (res); res = res->link.next)
-    ;
+  assert (quantor->opts.function_resolution);
+  assert (v->functions.first);
 
-  return res;
-}
+  f = v->cheapest_function_to_substitute;
+  assert (f);
+  assert (f->lhs->var == v);
 
-/*------------------------------------------------------------------------*/
+  if (f->type == QUANTOR_OR_GATE)
+    mark_clauses_of_substituted_function (quantor, f, 1);
+  else if (find_gate_clauses (quantor, f, gate_clauses))
+    {
+      for (i = 0; i < 4; i++)
+	gate_clauses[i]->part_of_substituted_function = 1;
+    }
+  else
+    return 0;
 
-static int
-literals_per_clause_limit_exceeded (Quantor * quantor, Var * existential_var)
-{
-  int sum, res, len;
-  Scope *scope;
-  double ratio;
+  INCSTATS2 (quantor->stats.exists_function_resolution);
 
-  assert (is_existential (existential_var));
-  scope = first_non_empty_innermost_existential_scope (quantor);
-  sum = existential_var->score;
-  len = 0;
-  while (scope)
+  pos = var2lit (v, 0);
+  neg = var2lit (v, 1);
+
+  for (p = pos->column.first; p; p = p->column_link.next)
+    for (q = neg->column.first; q; q = q->column_link.next)
+      {
+	a = p->clause;
+	b = q->clause;
+
+	if (a->part_of_substituted_function ==
+	    b->part_of_substituted_function)
+	  continue;
+
+	resolve (quantor, v, a, b);
+      }
+
+  if (f->type == QUANTOR_OR_GATE)
+    mark_clauses_of_substituted_function (quantor, f, 0);
+  else
     {
-      sum += scope->sum;
-      len += scope->clauses.len;
-      scope = scope->link.next;
+      for (i = 0; i < 4; i++)
+	gate_clauses[i]->part_of_substituted_function = 0;
     }
-  assert (len > 0);
-  ratio = sum / (double) len;
-#ifdef QUANTOR_LOG5
-  LOG (quantor, 5, "NEW RATIO AFTER EXISTS WOULD BE %.1f", ratio);
-#endif
-  res = (ratio >= quantor->opts.literals_per_clause_limit);
 
-  return res;
+  return 1;
 }
 
 /*------------------------------------------------------------------------*/
-#ifndef NDEBUG
-/*------------------------------------------------------------------------*/
-
+/* To eliminate an existential variable we remove all clauses in which the
+ * variable occurs (positively or negatively) and add all possible
+ * resolvents of this variable.  This is the same elimination procedure as
+ * in the original resolution based Davis and Putnam procedure.
+ */
 static void
-check_basically_simplified (Quantor * quantor)
+exists (Quantor * quantor, Var * v)
 {
-  assert (!quantor->units.first);
-  assert (!quantor->unates.first);
-  assert (!quantor->dying_clauses.first);
-}
+  int prev_phase;
 
-/*------------------------------------------------------------------------*/
+  assert (is_existential (v));
+
+  INCSTATS1 (quantor->stats.exists);
+  prev_phase = enter_phase (quantor, QUANTOR_PHASE_EXISTS);
+
+  if (!v->cheapest_function_to_substitute ||
+      !substitute_cheapest_function (quantor, v))
+    resolve_all_clauses_with (quantor, v);
+
+  remove_all_clauses_with (quantor, var2lit (v, 1));
+  remove_all_clauses_with (quantor, var2lit (v, 0));
+
+  gc (quantor);
+  leave_phase (quantor, prev_phase);
+
+#if 0
+  {
+    static int count = 0;
+    char buffer[200];
+    sprintf (buffer, "/tmp/quantor-after-exists-%d.cnf", count++);
+    FILE * file = fopen (buffer, "w");
+    quantor_print (quantor, file);
+    fclose (file);
+  }
 #endif
+}
+
 /*------------------------------------------------------------------------*/
 
-static Var *
-cheapest_existential (Quantor * quantor, int *cost_ptr, const char *msg)
+static void
+map_var (Quantor * quantor, Var * v)
 {
-  Var *res, *tmp;
-  Scope *p;
+  assert (!is_assigned_var (v));
+  assert (!v->mapped);
+  v->mapped = gen_Var (quantor, default_scope (quantor));
+#ifdef QUANTOR_LOG5
+  LOG (quantor, 5, "MAPPED VARIABLE %d TO GENERIC VARIABLE %d",
+       v->idx, v->mapped->idx);
+#endif
+}
 
-  res = 0;
-  for (p = quantor->scopes.last; p; p = p->link.prev)
-    {
-      if (is_empty_Scope (p))
-	continue;
+/*------------------------------------------------------------------------*/
 
-      if (p->type == QUANTOR_UNIVERSAL)
-	break;
+static Lit *
+map_lit (Lit * lit)
+{
+  Var *target;
+  Lit *res;
 
-      reorder_scope (quantor, p);
-      assert (count_PtrStack (&p->order) > 0);
-      tmp = p->order.start[0];
-      if (!res || res->score > tmp->score)
-	res = tmp;
+  target = lit->var->mapped;
+  if (target)
+    {
+      res = target->lits;
+      if (!is_signed (lit))
+	res = QUANTOR_NOT (res);
     }
-
-  assert (res);
-#ifdef QUANTOR_LOG4
-  LOG (quantor, 4,
-       "CHEAPEST %s VARIABLE %d HAS EXPECTED COST OF %s",
-       msg, res->idx, score2str (quantor, res->score));
-#else
-  (void) msg;
-#endif
-  *cost_ptr = res->score;
+  else
+    res = lit;
 
   return res;
 }
 
 /*------------------------------------------------------------------------*/
-
-static Var *
-cheapest_universal (Quantor * quantor, int *cost_ptr)
+/* There are three cases:                     
+ *                                             {l0, l1, l2}
+ *
+ *   1. variable does not occur in clause:     v, -v not in {l0, l1, l2}
+ *
+ *     keep old clause                         {l0, l1, l2}
+ *     map clause as a whole                   {l0', l1', l2'}
+ *
+ *   2. lit in clause:                         l0 = v
+ *     
+ *     kill old clause                         --------
+ *     copy clause without lit                 {l1, l2}
+ *     
+ *   3. not_lit in clause:                     l0 = -v
+ *     
+ *     kill old clause                         ----------
+ *     map clause without not_lit              {l1', l2'}
+ *
+ * Note, that 'mapping' really means mapping all literals (l) of the clause
+ * to their 'mapped' counterpart (l').  Copying keeps the old literals!
+ */
+static void
+forall_clause (Quantor * quantor, Clause * clause, Var * v)
 {
-  int cost, min_cost, removed, added;
-  Scope *p, *existential_scope;
-  Var *res, *tmp;
+  Lit *lit, *not_lit, *old_lit, *new_lit;
+  int found_lit, found_not_lit;
+  Clause *added_clause;
+  Cell *p, *eor;
+#ifndef NDEBUG
+  int size = clause->size;
+  int count = size;
+#endif
 
-  existential_scope = first_non_empty_innermost_existential_scope (quantor);
+  not_lit = v->lits;
+  lit = QUANTOR_NOT (not_lit);
+  found_not_lit = found_lit = 0;
 
-  added = 0;
-  for (p = existential_scope; p; p = p->link.next)
-    added += p->sum;
+  eor = end_of_row (clause);
 
-  res = 0;
-  min_cost = INT_MAX;
+  for (p = clause->row; !found_lit && !found_not_lit && p < eor; p++)
+    {
+      old_lit = p->lit;
+      if (lit == old_lit)
+	found_lit = 1;		/* case 2. */
+      else if (not_lit == old_lit)
+	found_not_lit = 1;	/* case 3. */
+    }
 
-  for (p = existential_scope->link.prev; p; p = p->link.prev)
+  assert (!(found_not_lit && found_lit));
+
+  if (found_not_lit || found_lit)	/* case 2. or 3. */
     {
-      if (is_empty_Scope (p))
-	continue;
+      kill_Clause (quantor, clause);
+#ifndef NDEBUG
+      count -= size;
+#endif
+    }
 
-      if (p->type == QUANTOR_EXISTENTIAL)
-	break;
+  if (found_lit)		/* case 2. */
+    {
+      assert (!found_not_lit);
+      assert (!count_PtrStack (&quantor->new_clause));
 
-      reorder_scope (quantor, p);
-      assert (count_PtrStack (&p->order) > 0);
-      tmp = p->order.start[0];
-      removed = tmp->score;
-      assert (removed == QUANTOR_OVERFLOW || removed < 0);
-      cost = add_with_overflow (removed, added);
-      if (!res || min_cost > cost)
+      for (p = clause->row; p < eor; p++)
 	{
-	  res = tmp;
-	  min_cost = cost;
+	  old_lit = p->lit;
+	  if (old_lit != lit)
+	    push_PtrStack (quantor, &quantor->new_clause, old_lit);
 	}
+
+      added_clause = add_new_clause (quantor, "FORALL");
+      (void) added_clause;
+#ifndef NDEBUG
+      count += added_clause ? added_clause->size : 0;
+#endif
     }
 
-  assert (res);
-#ifdef QUANTOR_LOG4
-  LOG (quantor, 4,
-       "CHEAPEST INNER UNIVERSAL VARIABLE %d HAS EXPECTED COST OF %s",
-       res->idx, score2str (quantor, min_cost));
+  if (!found_lit)		/* case 1. or 3. */
+    {
+      assert (!count_PtrStack (&quantor->new_clause));
+      for (p = clause->row; p < eor; p++)
+	{
+	  old_lit = p->lit;
+	  if (old_lit != not_lit)
+	    {
+	      new_lit = map_lit (old_lit);
+	      push_PtrStack (quantor, &quantor->new_clause, new_lit);
+	    }
+	}
+      if (found_not_lit)
+	added_clause = add_new_clause (quantor, "FORALL MAPPED REDUCED");
+      else
+	added_clause = add_new_clause (quantor, "FORALL MAPPED");
+#ifndef NDEBUG
+      count += added_clause ? added_clause->size : 0;
 #endif
-  *cost_ptr = min_cost;
+    }
 
-  return res;
+#ifndef NDEBUG
+  if (found_not_lit || found_lit)
+    assert (count <= size - 1);
+  else
+    assert (count <= 2 * size);
+#endif
 }
 
 /*------------------------------------------------------------------------*/
 
-static int
-reached_hard_exists_limit (Quantor * quantor, int cost)
+static void
+unmap_var (Quantor * quantor, Var * v)
 {
-  if (cost < quantor->opts.hard_exists_limit)
-    return 0;
-
-#ifdef QUANTOR_LOG4
-  LOG (quantor, 4, "COST %d REACHED HARD EXISTS LIMIT %d",
-       cost, quantor->opts.hard_exists_limit);
-#endif
+  (void) quantor;
 
-  return 1;
+  assert (v->mapped);
+  v->mapped = 0;
 }
 
 /*------------------------------------------------------------------------*/
-
-static int
-reached_soft_exists_limit (Quantor * quantor, int cost)
+/* Implementation of the scope reduction optimization enabled by
+ * 'reduce_scope = 1'.   This is particular useful for problems of the
+ * following form:
+ *
+ *   exists u, v. forall x, y. exists a, b, c, d.
+ *
+ *     w(u,v) & 		// can be ignored
+ *     f(u,a) & g(v,b) &	// outer clauses
+ *     p(x,a) & q(a,c) &	// connect a to c
+ *     s(y,b) & t(b,d)          // connect b to d
+ *
+ *   ==
+ *
+ *   exists u, v.
+ *
+ *     w(u,v) &
+ *    
+ *     (forall x. exists a, c. f(u,a) & p(x,a) & q(a,c)) &
+ *
+ *     (forall y. exists b, d. g(v,b) & s(y,b) & t(b,d))
+ *
+ *   ==
+ *
+ *   exists u, v, a, c, a', c'.
+ *
+ *     w(u,v) &
+ *    
+ *     (f(u,a) & p(x,a) & q(a,c))) [0/x] &
+ *     (f(u,a') & p(x,a') & q(a',c'))) [1/x] &
+ *
+ *     (forall y. exists b, d. g(v,b) & s(y,b) & t(b,d))
+ *
+ *   ==
+ *
+ *   exists u, v, a, b, c, d, a', b', c', d'.
+ *
+ *     w(u,v) &
+ *    
+ *     (f(u,a) & p(x,a) & q(a,c))) [0/x] &
+ *     (f(u,a') & p(x,a') & q(a',c'))) [1/x] &
+ *
+ *     (g(v,b) & s(y,b) & t(b,d))) [0/y] &
+ *     (g(v,b') & s(y,b') & t(b',d'))) [1/y]
+ *
+ * Note that expanding x and y without scope reduction would result in
+ * drippling the number of copies of 'a, b, c, d' from 4 to 12.  Also many
+ * more clauses would have been 'mapped'.
+ *
+ * In the next function we mark all variables that recursively share a
+ * clause with 'quantified_var' ignoring variables with lower nesting, with
+ * the 'quantified_var' as an exception.  These marked variables and the
+ * clauses connecting them are the only clauses that need to be copied in
+ * forall expansion.  The connecting clauses are marked as well.
+ */
+static void
+mark_to_be_mapped (Quantor * quantor, Var * quantified_var)
 {
-  int i, res, len, *literals;
-  double sum, avg;
+  unsigned num_mapped_vars, num_mapped_clauses;
+  Cell *p, *q, *eor;
+  Scope *first_scope;
+  Var *var, *tmp;
+  PtrStack stack;
+  Clause *c;
+  int sign;
+
+  assert (!quantified_var->to_be_mapped);
+  num_mapped_vars = num_mapped_clauses = 0;
+  first_scope = first_non_empty_innermost_existential_scope (quantor);
+
+  init_PtrStack (quantor, &stack);
+  push_PtrStack (quantor, &stack, quantified_var);
+
+  while (count_PtrStack (&stack))
+    {
+      var = pop_PtrStack (quantor, &stack);
+
+      if (var != quantified_var && var->scope->nesting < first_scope->nesting)
+	continue;
+
+      if (var->to_be_mapped)
+	continue;
+
+      var->to_be_mapped = 1;
+      num_mapped_vars++;
+
+      for (sign = 0; sign <= 1; sign++)
+	{
+	  for (p = var->lits[sign].column.first; p; p = p->column_link.next)
+	    {
+	      c = p->clause;
+	      if (c->to_be_mapped)
+		continue;
 
-  sum = cost;
-  len = quantor->opts.soft_exists_length;
-  literals = quantor->opts.literals_added_by_exists;
+	      c->to_be_mapped = 1;
+	      num_mapped_clauses++;
 
-  for (i = 0; i < len; i++)
-    sum += literals[i];
+	      eor = end_of_row (c);
+	      for (q = c->row; q < eor; q++)
+		{
+		  tmp = q->lit->var;
+		  if (tmp->to_be_mapped)
+		    continue;
 
-  assert (len >= 0);
-  avg = sum / (double) (len + 1);
+		  push_PtrStack (quantor, &stack, tmp);
+		}
+	    }
+	}
+    }
+  release_PtrStack (quantor, &stack);
 
-#ifdef QUANTOR_LOG4
-  LOG (quantor, 4, "AVERAGE LAST %d EXIST COSTS IS %.2f", len, avg);
-#endif
+  assert (quantified_var->to_be_mapped);
+  quantified_var->to_be_mapped = 0;
+  num_mapped_vars--;
 
-  if (avg >= (double) quantor->opts.soft_exists_limit)
-    {
 #ifdef QUANTOR_LOG4
-      LOG (quantor, 4, "SOFT EXIST LIMIT %d REACHED",
-	   quantor->opts.soft_exists_limit);
+  LOG (quantor, 4, "MARKED %u VARIABLES AND %u CLAUSES TO BE MAPPED",
+       num_mapped_vars, num_mapped_clauses);
 #endif
-      res = 1;
-    }
-  else
-    res = 0;
-
-  return res;
 }
 
 /*------------------------------------------------------------------------*/
-
+/* Compare with the comments to 'mark_to_be_mapped'.  Note, that this
+ * optimizations can be disabled by setting 'reduce_scope = 0'.
+ */
 static void
-save_actual_exists_costs (Quantor * quantor, int actual_cost)
+collect_mapped_vars (Quantor * quantor, PtrStack * mapped_vars)
 {
-  int i, len, *literals;
-
-  len = quantor->opts.soft_exists_length;
-  if (len <= 0)
-    return;
-
-  literals = quantor->opts.literals_added_by_exists;
-
-  for (i = 1; i < len; i++)
-    literals[i - 1] = literals[i];
+  Scope *scope, *first_scope, *last_scope, *end;
+  unsigned num_candidates, num_collected;
+  Var *v;
 
-  literals[len - 1] = actual_cost;
-}
+  first_scope = first_non_empty_innermost_existential_scope (quantor);
+  last_scope = last_non_empty_existential_scope (quantor);
+  end = last_scope->link.next;
+  assert (last_scope->nesting >= first_scope->nesting);
 
-/*------------------------------------------------------------------------*/
+  num_candidates = num_collected = 0;
 
-static int
-reached_exists_limit (Quantor * quantor, int cost)
-{
-  if (reached_hard_exists_limit (quantor, cost))
-    return 1;
+  for (scope = first_scope; scope != end; scope = scope->link.next)
+    {
+      for (v = scope->vars.first; v; v = v->scope_link.next)
+	{
+	  num_candidates++;
 
-  if (reached_soft_exists_limit (quantor, cost))
-    return 1;
+	  if (quantor->opts.reduce_scope && !v->to_be_mapped)
+	    continue;
 
-  return 0;
+	  num_collected++;
+	  v->to_be_mapped = 0;
+	  push_PtrStack (quantor, mapped_vars, v);
+	}
+    }
+#ifdef QUANTOR_LOG4
+  LOG (quantor, 4, "COLLECTED %u VARIABLES OUT OF %u (%.1f%%)",
+       num_collected, num_candidates,
+       num_candidates ? 100.0 * num_collected / (double) num_candidates : 0);
+#endif
 }
 
 /*------------------------------------------------------------------------*/
-
-static Var *
-pivot (Quantor * quantor, int *expected_cost_ptr)
+/* See 'collect_mapped_vars' and 'mark_to_be_mapped'.
+ */
+static void
+collect_mapped_clauses (Quantor * quantor, PtrStack * mapped_clauses)
 {
-  int existential_cost, universal_cost, choose_universal;
-  Var *res, *existential_var, *universal_var;
-  double biased_cost;
-
-#ifndef NDEBUG
-  check_basically_simplified (quantor);
-#endif
-  if (!quantor->opts.exists && !quantor->opts.forall)
-    return 0;
+  Scope *scope, *first_scope, *last_scope, *end;
+  unsigned num_candidates, num_collected;
+  Clause *c;
 
-  existential_cost = universal_cost = 0;
-  existential_var = universal_var = 0;
+  first_scope = first_non_empty_innermost_existential_scope (quantor);
+  last_scope = last_non_empty_existential_scope (quantor);
+  end = last_scope->link.next;
+  assert (last_scope->nesting >= first_scope->nesting);
 
-  if (quantor->opts.exists)
-    existential_var =
-      cheapest_existential (quantor, &existential_cost, "INNER EXISTENTIAL");
+  num_candidates = num_collected = 0;
 
-  if (quantor->opts.exists && !quantor->opts.forall)
-    {
-#ifdef QUANTOR_LOG5
-      LOG (quantor, 5, "CHOOSING EXIST SINCE FORALL IS DISABLED");
-#endif
-      choose_universal = 0;
-    }
-  else if (quantor->opts.exists &&
-	   !reached_exists_limit (quantor, existential_cost))
-    {
-      INCSTATS2 (quantor->stats.smaller_exists_limit);
-#ifdef QUANTOR_LOG5
-      LOG (quantor, 5, "EXISTENTIAL COST IS BELOW EXISTS LIMIT");
-#endif
-      choose_universal = 0;
-    }
-  else
+  for (scope = first_scope; scope != end; scope = scope->link.next)
     {
-      assert (quantor->opts.forall);
-      universal_var = cheapest_universal (quantor, &universal_cost);
-      if (!quantor->opts.exists)
-	{
-	  choose_universal = 1;
-	}
-      else if (quantor->opts.exists &&
-	       literals_per_clause_limit_exceeded (quantor, existential_var))
-	{
-#ifdef QUANTOR_LOG5
-	  LOG (quantor, 5, "EXISTS WOULD EXCEED LITERALS PER CLAUSE RATIO");
-#endif
-	  INCSTATS2 (quantor->stats.literals_per_clause_limit_exceeded);
-	  quantor->opts.literals_per_clause_limit *=
-	    quantor->opts.literals_per_clause_factor;
-	  choose_universal = 1;
-	}
-      else
+      for (c = scope->clauses.first; c; c = c->scope_link.next)
 	{
-	  biased_cost = quantor->opts.forall_bias * existential_cost;
-	  choose_universal = (universal_cost <= biased_cost);
-#ifdef QUANTOR_LOG5
-	  LOG (quantor, 5,
-	       "UNIVERSAL COST %d %s BIASED EXISTENTIAL COST %.0f",
-	       universal_cost, choose_universal ? "<=" : ">", biased_cost);
-#endif
-	}
-    }
+	  num_candidates++;
+	  if (quantor->opts.reduce_scope && !c->to_be_mapped)
+	    continue;
 
-  if (choose_universal)
-    {
-      assert (universal_var);
-      *expected_cost_ptr = universal_cost;
-      res = universal_var;
-    }
-  else
-    {
-      assert (existential_var);
-      *expected_cost_ptr = existential_cost;
-      res = existential_var;
+	  num_collected++;
+	  c->to_be_mapped = 0;
+	  push_PtrStack (quantor, mapped_clauses, c);
+	}
     }
 
-  return res;
+#ifdef QUANTOR_LOG4
+  LOG (quantor, 4, "COLLECTED %u CLAUSES OUT OF %u (%.1f%%)",
+       num_collected, num_candidates,
+       num_candidates ? 100.0 * num_collected / (double) num_candidates : 0);
+#endif
 }
 
 /*------------------------------------------------------------------------*/
-
+/* This is an expensive elimination procedure for one universally quantified
+ * var.  Here is the logic:
+ *
+ *   exists a, b. forall x, y. exists c, d. 
+ *
+ *     f(a,b) & 
+ *     g (a,b,c,d,x,y)
+ *
+ *   ==
+ *
+ *   exists a, b. forall y. exists c, d, c', d'. 
+ *
+ *     f(a,b) &
+ *     g(a,b,c, d, 0,y) &
+ *     g(a,b,c',d',1,y)
+ *
+ * The mapped clauses are copied one after the other on purpose.  Mapping
+ * the literals of a clause is cheap.  Most of the time is spent in
+ * 'add_new_clause', which checks backward subsumption against the clauses
+ * copied before, and links the new clause into the occurrence lists,
+ * signatures and clause indices.  These are shared by all clauses, and the
+ * literal marks used for subsumption are global too.  Copying clauses
+ * concurrently would therefore still need a sequential merge doing
+ * exactly this work.
+ */
 static void
-add_literals_of_clause_except (Quantor * quantor, Clause * c, Var * v)
+forall (Quantor * quantor, Var * quantified_var)
 {
-  Lit *pos, *neg, *lit;
-  Cell *p, *eor;
-#ifndef NDEBUG
-  Lit *found = 0;
-#endif
-
-  pos = v->lits;
-  neg = pos + 1;
+  PtrStack mapped_clauses, mapped_vars;
+  int prev_phase;
+  void **p;
 
-  eor = end_of_row (c);
-  for (p = c->row; p < eor; p++)
-    {
-      lit = p->lit;
+  prev_phase = enter_phase (quantor, QUANTOR_PHASE_FORALL);
+  forward_subsume (quantor);
 
-      if (lit == pos || lit == neg)
-	{
+  assert (is_universal (quantified_var));
 #ifndef NDEBUG
-	  assert (!found);
-	  found = lit;
+  quantor->entered_forall = quantified_var;
 #endif
-	}
-      else
-	push_PtrStack (quantor, &quantor->new_clause, lit);
-    }
+  init_PtrStack (quantor, &mapped_vars);
+  init_PtrStack (quantor, &mapped_clauses);
 
-  assert (found);
-}
+  mark_to_be_mapped (quantor, quantified_var);
 
-/*------------------------------------------------------------------------*/
+  collect_mapped_vars (quantor, &mapped_vars);
+  for (p = mapped_vars.start; p < mapped_vars.top; p++)
+    map_var (quantor, *p);
 
-static void
-resolve (Quantor * quantor, Var * v, Clause * c, Clause * d)
-{
-#ifdef QUANTOR_LOG6
-  LOG (quantor, 6, "RESOLVING CLAUSE %d AND CLAUSE %d ON %d",
-       c->idx, d->idx, v->idx);
+  collect_mapped_clauses (quantor, &mapped_clauses);
+  for (p = mapped_clauses.start; p < mapped_clauses.top; p++)
+    forall_clause (quantor, *p, quantified_var);
+
+  release_PtrStack (quantor, &mapped_clauses);
+
+  for (p = mapped_vars.start; p < mapped_vars.top; p++)
+    unmap_var (quantor, *p);
+
+  release_PtrStack (quantor, &mapped_vars);
+
+  INCSTATS1 (quantor->stats.foralls);
+  bcp (quantor);
+#ifndef NDEBUG
+  quantor->entered_forall = 0;
 #endif
-  assert (!count_PtrStack (&quantor->new_clause));
-  add_literals_of_clause_except (quantor, c, v);
-  add_literals_of_clause_except (quantor, d, v);
-  add_new_clause (quantor, "RESOLVED");
+  leave_phase (quantor, prev_phase);
 }
 
 /*------------------------------------------------------------------------*/
 
-static void
-resolve_all_clauses_with (Quantor * quantor, Var * v)
+static unsigned
+count_remaining_literals (Quantor * quantor)
 {
-  Lit *neg, *pos;
-  Cell *p, *q;
+  unsigned res;
+  Scope *scope;
 
-  pos = var2lit (v, 0);
-  neg = var2lit (v, 1);
+  res = 0;
+  for (scope = quantor->scopes.first; scope; scope = scope->link.next)
+    res += scope->sum;
 
-  for (p = pos->column.first; p; p = p->column_link.next)
-    for (q = neg->column.first; q; q = q->column_link.next)
-      resolve (quantor, v, p->clause, q->clause);
+  return res;
 }
 
 /*------------------------------------------------------------------------*/
 
 static void
-remove_all_clauses_with (Quantor * quantor, Lit * lit)
+trace_elimination (Quantor * quantor,
+		   const char *type, int idx, int expected_cost, int delta)
 {
-  Cell *p, *next;
+  double seconds;
 
-  for (p = lit->column.first; p; p = next)
-    {
-      next = p->column_link.next;
-      kill_Clause (quantor, p->clause);
-    }
+  seconds = get_time () - quantor->stats.time;
+  report (quantor,
+	  "trace %s %u %s %d expected %d added %d clauses %u literals %u "
+	  "%.2f seconds",
+	  get_strategy (quantor)->name, quantor->progress.eliminations,
+	  type, idx, expected_cost, delta, quantor->clauses.len,
+	  count_remaining_literals (quantor), (seconds > 0) ? seconds : 0);
 }
 
 /*------------------------------------------------------------------------*/
 
 static void
-mark_clauses_of_substituted_function (Quantor * quantor,
-				      Function * f, int new_mark)
+eliminate (Quantor * quantor, Var * v, int expected_cost)
 {
-  Clause *clause, *binary_clause;
-  Lit *lit, *not_lit, *lhs;
-  Cell *p, *eor;
-  int found_lhs;
+  int delta, was_existential, idx;
+#ifdef QUANTOR_LOG4
+  const char *type = is_existential (v) ? "EXISTS" : "FORALL";
+  LOG (quantor, 4, "%s %d EXPECTS COST %s",
+       type, v->idx, score2str (quantor, expected_cost));
+#endif
+  idx = v->idx;
+  assert (v->scope);
+  assert (!v->eliminated);
 
-  lhs = f->lhs;
-  clause = f->clause;
-  assert (clause->part_of_substituted_function != new_mark);
-  clause->part_of_substituted_function = new_mark;
+  quantor->stats.eliminated_cells = 0;
+  quantor->progress.eliminations++;
 
-  found_lhs = 0;
-  (void) found_lhs;
-  eor = end_of_row (clause);
-  for (p = clause->row; p < eor; p++)
-    {
-      lit = p->lit;
-      not_lit = QUANTOR_NOT (lit);
-      if (not_lit == lhs)
-	{
-	  found_lhs = 1;
-	  continue;
-	}
+  v->eliminated = 1;
+  if (v->eqclass)
+    v->eqclass->num_eliminated++;
 
-      binary_clause = find_binary_clause (quantor, lhs, not_lit);
-      assert (binary_clause);
-      assert (binary_clause->part_of_substituted_function == !new_mark);
-      binary_clause->part_of_substituted_function = new_mark;
-    }
+  if ((was_existential = is_existential (v)))
+    exists (quantor, v);
+  else
+    forall (quantor, v);
 
-  assert (found_lhs);
+  /************************************/
+  /* NOTE: 'v' may now be invalid !!! */
+  /************************************/
+
+  delta = quantor->stats.eliminated_cells;
+  assert (quantor->invalid || delta <= expected_cost);
+#ifdef QUANTOR_LOG4
+  LOG (quantor, 4,
+       "%s %d ADDED %d LITERALS (EXPECTED %s)",
+       type, idx, delta, score2str (quantor, expected_cost));
+#endif
+  if (was_existential)
+    save_actual_exists_costs (quantor, delta);
+
+  if (quantor->opts.trace)
+    trace_elimination (quantor,
+		       was_existential ? "exists" : "forall",
+		       idx, expected_cost, delta);
+
+#ifdef QUANTOR_LOG4
+  LOG (quantor, 4, "SCOPES AFTER ELIMINATION OF VARIABLE %d:", idx);
+#endif
+#ifdef QUANTOR_LOG3
+  log_scopes (quantor, 3);
+#endif
+  check_invariant (quantor, 1);
 }
 
 /*------------------------------------------------------------------------*/
 
-static void
-substitute_cheapest_function (Quantor * quantor, Var * v)
+static int
+is_trivial (Quantor * quantor, QuantorResult * res_ptr)
 {
-  Lit *neg, *pos;
-  Clause *a, *b;
-  Function *f;
-  Cell *p, *q;
+  QuantorResult res;
 
-  assert (quantor->opts.function_resolution);
-  assert (v->functions.first);
+  if (quantor->invalid)
+    res = QUANTOR_RESULT_UNSATISFIABLE;
+  else if (!quantor->clauses.len)
+    res = QUANTOR_RESULT_SATISFIABLE;
+  else
+    res = QUANTOR_RESULT_UNKNOWN;
 
-  INCSTATS2 (quantor->stats.exists_function_resolution);
+  if (res_ptr)
+    *res_ptr = res;
 
-  f = v->cheapest_function_to_substitute;
-  assert (f);
-  assert (f->lhs->var == v);
-  mark_clauses_of_substituted_function (quantor, f, 1);
+  return res != QUANTOR_RESULT_UNKNOWN;
+}
 
-  pos = var2lit (v, 0);
-  neg = var2lit (v, 1);
+/*------------------------------------------------------------------------*/
 
-  for (p = pos->column.first; p; p = p->column_link.next)
-    for (q = neg->column.first; q; q = q->column_link.next)
-      {
-	a = p->clause;
-	b = q->clause;
+static int
+timeout (Quantor * quantor)
+{
+  double delta;
+  int res;
 
-	if (a->part_of_substituted_function ==
-	    b->part_of_substituted_function)
-	  continue;
+  if (quantor->opts.time_limit < 0)
+    return 0;
 
-	resolve (quantor, v, a, b);
-      }
+  delta = get_time () - quantor->stats.time;
+  res = (delta >= quantor->opts.time_limit);
 
-  mark_clauses_of_substituted_function (quantor, f, 0);
+  return res;
 }
 
 /*------------------------------------------------------------------------*/
-/* To eliminate an existential variable we remove all clauses in which the
- * variable occurs (positively or negatively) and add all possible
- * resolvents of this variable.  This is the same elimination procedure as
- * in the original resolution based Davis and Putnam procedure.
- */
-static void
-exists (Quantor * quantor, Var * v)
-{
-  assert (is_existential (v));
-
-  INCSTATS1 (quantor->stats.exists);
 
-  if (v->cheapest_function_to_substitute)
-    substitute_cheapest_function (quantor, v);
-  else
-    resolve_all_clauses_with (quantor, v);
+static int
+spaceout (Quantor * quantor)
+{
+  double mb;
+  int res;
 
-  remove_all_clauses_with (quantor, var2lit (v, 1));
-  remove_all_clauses_with (quantor, var2lit (v, 0));
+  if (quantor->opts.space_limit < 0)
+    return 0;
 
-  gc (quantor);
+  mb = footprint (quantor);
+  mb /= (1 << 20);
+  res = (mb >= quantor->opts.space_limit);
 
-#if 0
-  {
-    static int count = 0;
-    char buffer[200];
-    sprintf (buffer, "/tmp/quantor-after-exists-%d.cnf", count++);
-    FILE * file = fopen (buffer, "w");
-    quantor_print (quantor, file);
-    fclose (file);
-  }
-#endif
+  return res;
 }
 
 /*------------------------------------------------------------------------*/
 
-static void
-map_var (Quantor * quantor, Var * v)
+static QuantorResult
+report_progress (Quantor * quantor)
 {
-  assert (!is_assigned_var (v));
-  assert (!v->mapped);
-  v->mapped = gen_Var (quantor, default_scope (quantor));
-#ifdef QUANTOR_LOG5
-  LOG (quantor, 5, "MAPPED VARIABLE %d TO GENERIC VARIABLE %d",
-       v->idx, v->mapped->idx);
-#endif
+  Progress *progress = &quantor->progress;
+  QuantorProgress snapshot;
+  QuantorResult res;
+  Scope *scope;
+  double delta;
+
+  if (!progress->callback)
+    return QUANTOR_RESULT_UNKNOWN;
+
+  if (progress->eliminations < progress->next)
+    return QUANTOR_RESULT_UNKNOWN;
+
+  progress->next = progress->eliminations + progress->interval;
+
+  memset (&snapshot, 0, sizeof (snapshot));
+  snapshot.eliminations = progress->eliminations;
+  for (scope = quantor->scopes.first; scope; scope = scope->link.next)
+    {
+      snapshot.vars += scope->vars.len;
+      snapshot.literals += scope->sum;
+    }
+  snapshot.clauses = quantor->clauses.len;
+  snapshot.bytes = quantor->stats.bytes;
+  delta = get_time () - quantor->stats.time;
+  snapshot.seconds = (delta >= 0) ? delta : 0;
+
+  res = progress->callback (progress->state, &snapshot);
+  if (res == QUANTOR_RESULT_UNKNOWN || res == QUANTOR_RESULT_SPACEOUT)
+    return res;
+
+  return QUANTOR_RESULT_TIMEOUT;
 }
 
 /*------------------------------------------------------------------------*/
 
-static Lit *
-map_lit (Lit * lit)
+static int
+search_space_reached (Quantor * quantor)
 {
-  Var *target;
-  Lit *res;
+  double mb;
 
-  target = lit->var->mapped;
-  if (target)
-    {
-      res = target->lits;
-      if (!is_signed (lit))
-	res = QUANTOR_NOT (res);
-    }
-  else
-    res = lit;
+  if (quantor->opts.search <= 0 || quantor->opts.space_limit < 0)
+    return 0;
 
-  return res;
+  mb = footprint (quantor);
+  mb /= (1 << 20);
+
+  return 100.0 * mb >= quantor->opts.search * quantor->opts.space_limit;
 }
 
 /*------------------------------------------------------------------------*/
-/* There are three cases:                     
- *                                             {l0, l1, l2}
- *
- *   1. variable does not occur in clause:     v, -v not in {l0, l1, l2}
- *
- *     keep old clause                         {l0, l1, l2}
- *     map clause as a whole                   {l0', l1', l2'}
- *
- *   2. lit in clause:                         l0 = v
- *     
- *     kill old clause                         --------
- *     copy clause without lit                 {l1, l2}
- *     
- *   3. not_lit in clause:                     l0 = -v
- *     
- *     kill old clause                         ----------
- *     map clause without not_lit              {l1', l2'}
- *
- * Note, that 'mapping' really means mapping all literals (l) of the clause
- * to their 'mapped' counterpart (l').  Copying keeps the old literals!
- */
-static void
-forall_clause (Quantor * quantor, Clause * clause, Var * v)
+
+static QuantorResult search (Quantor *);
+
+/*------------------------------------------------------------------------*/
+
+static QuantorResult
+limit_reached (Quantor * quantor)
 {
-  Lit *lit, *not_lit, *old_lit, *new_lit;
-  int found_lit, found_not_lit;
-  Clause *added_clause;
-  Cell *p, *eor;
-#ifndef NDEBUG
-  int size = clause->size;
-  int count = size;
+#ifdef QUANTOR_FAST_ALLOC
+  compact_clauses (quantor);
 #endif
+  if (timeout (quantor))
+    return QUANTOR_RESULT_TIMEOUT;
 
-  not_lit = v->lits;
-  lit = QUANTOR_NOT (not_lit);
-  found_not_lit = found_lit = 0;
+  if (search_space_reached (quantor))
+    return search (quantor);
 
-  eor = end_of_row (clause);
+  if (spaceout (quantor))
+    return QUANTOR_RESULT_SPACEOUT;
 
-  for (p = clause->row; !found_lit && !found_not_lit && p < eor; p++)
-    {
-      old_lit = p->lit;
-      if (lit == old_lit)
-	found_lit = 1;		/* case 2. */
-      else if (not_lit == old_lit)
-	found_not_lit = 1;	/* case 3. */
-    }
+  return report_progress (quantor);
+}
 
-  assert (!(found_not_lit && found_lit));
+/*------------------------------------------------------------------------*/
+/* The limits are only checked between eliminations, but a single
+ * elimination may allocate more than the remaining space.  Therefore the
+ * memory needed by the next elimination, which adds 'cost' literals, is
+ * estimated from the average number of literals per clause and checked
+ * before the elimination is started.
+ */
+static int
+elimination_exceeds_space_limit (Quantor * quantor, int cost)
+{
+  double literals, bytes, limit;
+  Scope *scope;
 
-  if (found_not_lit || found_lit)	/* case 2. or 3. */
-    {
-      kill_Clause (quantor, clause);
-#ifndef NDEBUG
-      count -= size;
-#endif
-    }
+  if (quantor->opts.space_limit < 0 || cost <= 0)
+    return 0;
 
-  if (found_lit)		/* case 2. */
-    {
-      assert (!found_not_lit);
-      assert (!count_PtrStack (&quantor->new_clause));
+  literals = 0;
+  for (scope = quantor->scopes.first; scope; scope = scope->link.next)
+    literals += scope->sum;
 
-      for (p = clause->row; p < eor; p++)
-	{
-	  old_lit = p->lit;
-	  if (old_lit != lit)
-	    push_PtrStack (quantor, &quantor->new_clause, old_lit);
-	}
+  bytes = sizeof (Cell);
+  if (literals > 0)
+    bytes += quantor->clauses.len * (double) sizeof (Clause) / literals;
+  bytes *= cost;
+  bytes += footprint (quantor);
 
-      added_clause = add_new_clause (quantor, "FORALL");
-      (void) added_clause;
-#ifndef NDEBUG
-      count += added_clause ? added_clause->size : 0;
-#endif
-    }
+  /* With '--search' the search should start before the space limit is
+   * reached, since it needs memory for the SAT solver.
+   */
+  limit = quantor->opts.space_limit * (double) (1 << 20);
+  if (quantor->opts.search > 0)
+    limit *= quantor->opts.search / 100.0;
 
-  if (!found_lit)		/* case 1. or 3. */
-    {
-      assert (!count_PtrStack (&quantor->new_clause));
-      for (p = clause->row; p < eor; p++)
-	{
-	  old_lit = p->lit;
-	  if (old_lit != not_lit)
-	    {
-	      new_lit = map_lit (old_lit);
-	      push_PtrStack (quantor, &quantor->new_clause, new_lit);
-	    }
-	}
-      if (found_not_lit)
-	added_clause = add_new_clause (quantor, "FORALL MAPPED REDUCED");
-      else
-	added_clause = add_new_clause (quantor, "FORALL MAPPED");
-#ifndef NDEBUG
-      count += added_clause ? added_clause->size : 0;
-#endif
-    }
+  if (bytes < limit)
+    return 0;
 
-#ifndef NDEBUG
-  if (found_not_lit || found_lit)
-    assert (count <= size - 1);
-  else
-    assert (count <= 2 * size);
+#ifdef QUANTOR_LOG2
+  LOG (quantor, 2, "ELIMINATION WOULD NEED %.1f MB", bytes / (1 << 20));
 #endif
+  return 1;
 }
 
 /*------------------------------------------------------------------------*/
 
-static void
-unmap_var (Quantor * quantor, Var * v)
+static QuantorResult trivial_truth (Quantor *);
+static QuantorResult trivial_falsity (Quantor *);
+
+/*------------------------------------------------------------------------*/
+
+static QuantorResult
+trivial_truth_and_falsity (Quantor * quantor)
 {
-  (void) quantor;
+  QuantorResult res;
 
-  assert (v->mapped);
-  v->mapped = 0;
+  res = trivial_truth (quantor);
+  assert (res != QUANTOR_RESULT_UNSATISFIABLE);
+  if (res != QUANTOR_RESULT_UNKNOWN)
+    return res;
+
+  res = trivial_falsity (quantor);
+  assert (res != QUANTOR_RESULT_SATISFIABLE);
+
+  return res;
 }
 
 /*------------------------------------------------------------------------*/
-/* Implementation of the scope reduction optimization enabled by
- * 'reduce_scope = 1'.   This is particular useful for problems of the
- * following form:
- *
- *   exists u, v. forall x, y. exists a, b, c, d.
- *
- *     w(u,v) & 		// can be ignored
- *     f(u,a) & g(v,b) &	// outer clauses
- *     p(x,a) & q(a,c) &	// connect a to c
- *     s(y,b) & t(b,d)          // connect b to d
- *
- *   ==
- *
- *   exists u, v.
- *
- *     w(u,v) &
- *    
- *     (forall x. exists a, c. f(u,a) & p(x,a) & q(a,c)) &
- *
- *     (forall y. exists b, d. g(v,b) & s(y,b) & t(b,d))
- *
- *   ==
- *
- *   exists u, v, a, c, a', c'.
- *
- *     w(u,v) &
- *    
- *     (f(u,a) & p(x,a) & q(a,c))) [0/x] &
- *     (f(u,a') & p(x,a') & q(a',c'))) [1/x] &
- *
- *     (forall y. exists b, d. g(v,b) & s(y,b) & t(b,d))
- *
- *   ==
- *
- *   exists u, v, a, b, c, d, a', b', c', d'.
- *
- *     w(u,v) &
- *    
- *     (f(u,a) & p(x,a) & q(a,c))) [0/x] &
- *     (f(u,a') & p(x,a') & q(a',c'))) [1/x] &
- *
- *     (g(v,b) & s(y,b) & t(b,d))) [0/y] &
- *     (g(v,b') & s(y,b') & t(b',d'))) [1/y]
- *
- * Note that expanding x and y without scope reduction would result in
- * drippling the number of copies of 'a, b, c, d' from 4 to 12.  Also many
- * more clauses would have been 'mapped'.
- *
- * In the next function we mark all variables that recursively share a
- * clause with 'quantified_var' ignoring variables with lower nesting, with
- * the 'quantified_var' as an exception.  These marked variables and the
- * clauses connecting them are the only clauses that need to be copied in
- * forall expansion.  The connecting clauses are marked as well.
- */
-static void
-mark_to_be_mapped (Quantor * quantor, Var * quantified_var)
+
+static QuantorResult
+inner_quantified_variables_elimination_loop (Quantor * quantor)
 {
-  unsigned num_mapped_vars, num_mapped_clauses;
-  Cell *p, *q, *eor;
-  Scope *first_scope;
-  Var *var, *tmp;
-  PtrStack stack;
-  Clause *c;
-  int sign;
+  QuantorResult res;
+  Var *var;
+  int cost;
 
-  assert (!quantified_var->to_be_mapped);
-  num_mapped_vars = num_mapped_clauses = 0;
-  first_scope = first_non_empty_innermost_existential_scope (quantor);
+  for (;;)
+    {
+      bcp (quantor);
 
-  init_PtrStack (quantor, &stack);
-  push_PtrStack (quantor, &stack, quantified_var);
+      if (is_trivial (quantor, &res))
+	return res;
 
-  while (count_PtrStack (&stack))
-    {
-      var = pop_PtrStack (quantor, &stack);
+      if (is_propositional (quantor))
+	return QUANTOR_RESULT_UNKNOWN;
 
-      if (var != quantified_var && var->scope->nesting < first_scope->nesting)
-	continue;
+      if ((res = limit_reached (quantor)) != QUANTOR_RESULT_UNKNOWN)
+	return res;
 
-      if (var->to_be_mapped)
-	continue;
+      var = pivot (quantor, &cost);
+      if (!var)
+	return QUANTOR_RESULT_UNKNOWN;
 
-      var->to_be_mapped = 1;
-      num_mapped_vars++;
+      if (elimination_exceeds_space_limit (quantor, cost))
+	{
+	  if (quantor->opts.search > 0)
+	    return search (quantor);
 
-      for (sign = 0; sign <= 1; sign++)
+	  return QUANTOR_RESULT_SPACEOUT;
+	}
+
+      if (is_universal (var))
 	{
-	  for (p = var->lits[sign].column.first; p; p = p->column_link.next)
-	    {
-	      c = p->clause;
-	      if (c->to_be_mapped)
-		continue;
+	  res = trivial_truth_and_falsity (quantor);
+	  if (res != QUANTOR_RESULT_UNKNOWN)
+	    return res;
+	}
 
-	      c->to_be_mapped = 1;
-	      num_mapped_clauses++;
+      eliminate (quantor, var, cost);
+    }
+}
 
-	      eor = end_of_row (c);
-	      for (q = c->row; q < eor; q++)
-		{
-		  tmp = q->lit->var;
-		  if (tmp->to_be_mapped)
-		    continue;
+/*------------------------------------------------------------------------*/
+#ifdef QUANTOR_LOG2
+/*------------------------------------------------------------------------*/
 
-		  push_PtrStack (quantor, &stack, tmp);
-		}
-	    }
-	}
+#define MAX_WORST 1e12
+
+/*------------------------------------------------------------------------*/
+
+static double
+worst_case_number_vars_after_expansion_rec (Quantor * quantor, Scope * scope)
+{
+  Scope *next;
+  double res;
+  unsigned i;
+
+  if (!scope)
+    return 0;
+
+  next = scope->link.next;
+  res = worst_case_number_vars_after_expansion_rec (quantor, next);
+
+  if (scope->type == QUANTOR_EXISTENTIAL)
+    {
+      res += scope->vars.len;
+    }
+  else
+    {
+      for (i = 0; res < MAX_WORST && i < scope->vars.len; i++)
+	res *= 2.0;
     }
-  release_PtrStack (quantor, &stack);
 
-  assert (quantified_var->to_be_mapped);
-  quantified_var->to_be_mapped = 0;
-  num_mapped_vars--;
+  if (res >= MAX_WORST)
+    res = MAX_WORST;
 
-#ifdef QUANTOR_LOG4
-  LOG (quantor, 4, "MARKED %u VARIABLES AND %u CLAUSES TO BE MAPPED",
-       num_mapped_vars, num_mapped_clauses);
-#endif
+  return res;
 }
 
 /*------------------------------------------------------------------------*/
-/* Compare with the comments to 'mark_to_be_mapped'.  Note, that this
- * optimizations can be disabled by setting 'reduce_scope = 0'.
+
+static double
+worst_case_number_vars_after_expansion (Quantor * quantor)
+{
+  Scope *first = quantor->scopes.first;
+  return worst_case_number_vars_after_expansion_rec (quantor, first);
+}
+
+/*------------------------------------------------------------------------*/
+#endif
+/*------------------------------------------------------------------------*/
+/* A clause is blocked on an existential literal 'lit' if all resolvents on
+ * 'lit' are tautological on a literal at most as deeply nested as 'lit'.
+ * The literals of 'clause' have to be marked.  Visited literals are
+ * counted in '*steps_ptr'.
  */
-static void
-collect_mapped_vars (Quantor * quantor, PtrStack * mapped_vars)
+static int
+is_blocked_on (Quantor * quantor, Clause * clause, Lit * lit,
+	       unsigned *steps_ptr)
 {
-  Scope *scope, *first_scope, *last_scope, *end;
-  unsigned num_candidates, num_collected;
-  Var *v;
+  Cell *p, *q, *eor;
+  Lit *not_lit, *other;
+  Clause *resolvent;
+  int nesting, found;
 
-  first_scope = first_non_empty_innermost_existential_scope (quantor);
-  last_scope = last_non_empty_existential_scope (quantor);
-  end = last_scope->link.next;
-  assert (last_scope->nesting >= first_scope->nesting);
+  assert (is_existential (lit->var));
+  assert (lit->mark);
+  (void) clause;
 
-  num_candidates = num_collected = 0;
+  not_lit = QUANTOR_NOT (lit);
+  nesting = lit->var->scope->nesting;
 
-  for (scope = first_scope; scope != end; scope = scope->link.next)
+  for (p = not_lit->column.first; p; p = p->column_link.next)
     {
-      for (v = scope->vars.first; v; v = v->scope_link.next)
-	{
-	  num_candidates++;
+      resolvent = p->clause;
+      assert (resolvent != clause);
 
-	  if (quantor->opts.reduce_scope && !v->to_be_mapped)
+      if (is_dying_clause (quantor, resolvent))
+	continue;
+
+      found = 0;
+      eor = end_of_row (resolvent);
+      for (q = resolvent->row; !found && q < eor; q++)
+	{
+	  (*steps_ptr)++;
+	  other = q->lit;
+	  if (other == not_lit)
 	    continue;
 
-	  num_collected++;
-	  v->to_be_mapped = 0;
-	  push_PtrStack (quantor, mapped_vars, v);
+	  found = (QUANTOR_NOT (other)->mark &&
+		   other->var->scope->nesting <= nesting);
 	}
+
+      if (!found)
+	return 0;
     }
-#ifdef QUANTOR_LOG4
-  LOG (quantor, 4, "COLLECTED %u VARIABLES OUT OF %u (%.1f%%)",
-       num_collected, num_candidates,
-       num_candidates ? 100.0 * num_collected / (double) num_candidates : 0);
-#endif
+
+  return 1;
 }
 
 /*------------------------------------------------------------------------*/
-/* See 'collect_mapped_vars' and 'mark_to_be_mapped'.
+/* Returns the literal on which 'clause' is blocked or zero.  Exported
+ * literals do not block clauses.  Otherwise the assignment of the exported
+ * variables would have to be repaired after solving, which also has to
+ * follow every later substitution and elimination of exported variables.
+ * Flipping a literal of an inner scope does not change this assignment.
  */
-static void
-collect_mapped_clauses (Quantor * quantor, PtrStack * mapped_clauses)
+static Lit *
+find_blocking_literal (Quantor * quantor, Clause * clause,
+		       unsigned *steps_ptr)
 {
-  Scope *scope, *first_scope, *last_scope, *end;
-  unsigned num_candidates, num_collected;
-  Clause *c;
-
-  first_scope = first_non_empty_innermost_existential_scope (quantor);
-  last_scope = last_non_empty_existential_scope (quantor);
-  end = last_scope->link.next;
-  assert (last_scope->nesting >= first_scope->nesting);
+  Cell *p, *eor;
+  Lit *res, *lit;
 
-  num_candidates = num_collected = 0;
+  eor = end_of_row (clause);
+  for (p = clause->row; p < eor; p++)
+    {
+      lit = p->lit;
+      assert (!lit->mark);
+      lit->mark = 1;
+    }
 
-  for (scope = first_scope; scope != end; scope = scope->link.next)
+  res = 0;
+  for (p = clause->row; !res && p < eor; p++)
     {
-      for (c = scope->clauses.first; c; c = c->scope_link.next)
-	{
-	  num_candidates++;
-	  if (quantor->opts.reduce_scope && !c->to_be_mapped)
-	    continue;
+      lit = p->lit;
+      if (!is_existential (lit->var) || lit->var->exported)
+	continue;
 
-	  num_collected++;
-	  c->to_be_mapped = 0;
-	  push_PtrStack (quantor, mapped_clauses, c);
-	}
+      if (is_blocked_on (quantor, clause, lit, steps_ptr))
+	res = lit;
     }
 
-#ifdef QUANTOR_LOG4
-  LOG (quantor, 4, "COLLECTED %u CLAUSES OUT OF %u (%.1f%%)",
-       num_collected, num_candidates,
-       num_candidates ? 100.0 * num_collected / (double) num_candidates : 0);
-#endif
+  for (p = clause->row; p < eor; p++)
+    p->lit->mark = 0;
+
+  return res;
 }
 
 /*------------------------------------------------------------------------*/
-/* This is an expensive elimination procedure for one universally quantified
- * var.  Here is the logic:
- *
- *   exists a, b. forall x, y. exists c, d. 
- *
- *     f(a,b) & 
- *     g (a,b,c,d,x,y)
- *
- *   ==
- *
- *   exists a, b. forall y. exists c, d, c', d'. 
- *
- *     f(a,b) &
- *     g(a,b,c, d, 0,y) &
- *     g(a,b,c',d',1,y)
+/* Quantified blocked clause elimination.  Removing a clause may block
+ * other clauses, so we iterate until no more clauses are removed or the
+ * number of visited literals reaches '--qbce'.
  */
 static void
-forall (Quantor * quantor, Var * quantified_var)
+eliminate_blocked_clauses (Quantor * quantor)
 {
-  PtrStack mapped_clauses, mapped_vars;
-  void **p;
-
-  forward_subsume (quantor);
+  int removed;
+  Clause *clause;
+  unsigned steps;
+  Lit *lit;
 
-  assert (is_universal (quantified_var));
-#ifndef NDEBUG
-  quantor->entered_forall = quantified_var;
-#endif
-  init_PtrStack (quantor, &mapped_vars);
-  init_PtrStack (quantor, &mapped_clauses);
+  if (!quantor->opts.qbce)
+    return;
 
-  mark_to_be_mapped (quantor, quantified_var);
+  bcp (quantor);
+  if (quantor->invalid)
+    return;
 
-  collect_mapped_vars (quantor, &mapped_vars);
-  for (p = mapped_vars.start; p < mapped_vars.top; p++)
-    map_var (quantor, *p);
+  steps = 0;
 
-  collect_mapped_clauses (quantor, &mapped_clauses);
-  for (p = mapped_clauses.start; p < mapped_clauses.top; p++)
-    forall_clause (quantor, *p, quantified_var);
+  do
+    {
+      removed = 0;
 
-  release_PtrStack (quantor, &mapped_clauses);
+      for (clause = quantor->clauses.first;
+	   clause && steps < (unsigned) quantor->opts.qbce;
+	   clause = clause->link.next)
+	{
+	  if (is_dying_clause (quantor, clause))
+	    continue;
 
-  for (p = mapped_vars.start; p < mapped_vars.top; p++)
-    unmap_var (quantor, *p);
+	  steps++;
+	  lit = find_blocking_literal (quantor, clause, &steps);
+	  if (!lit)
+	    continue;
 
-  release_PtrStack (quantor, &mapped_vars);
+#ifdef QUANTOR_LOG5
+	  LOG (quantor, 5, "CLAUSE %d IS BLOCKED ON %d",
+	       clause->idx, lit2int (quantor, lit));
+#endif
+	  INCSTATS1 (quantor->stats.blocked_clauses);
+	  kill_Clause (quantor, clause);
+	  removed++;
+	}
+    }
+  while (removed && steps < (unsigned) quantor->opts.qbce);
 
-  INCSTATS1 (quantor->stats.foralls);
-  bcp (quantor);
-#ifndef NDEBUG
-  quantor->entered_forall = 0;
+#ifdef QUANTOR_LOG2
+  LOG (quantor, 2, "BLOCKED CLAUSE ELIMINATION VISITED %u LITERALS", steps);
 #endif
+  bcp (quantor);
 }
 
 /*------------------------------------------------------------------------*/
-
-static void
-eliminate (Quantor * quantor, Var * v, int expected_cost)
+/* Bounded variable addition replaces the product of the clauses 'L_i | C_j'
+ * for all literals 'L_i' in 'lits' and all remainders 'C_j' by 'x | C_j'
+ * and '-x | L_i', where 'x' is a new existential variable of the innermost
+ * scope.  Eliminating 'x' by resolution gives back the original clauses,
+ * so the assignment of the other variables does not change.
+ *
+ * The literals of the current clause except 'L_i' are marked with bit 0
+ * and the literals in 'lits' with bit 1 of 'mark'.
+ */
+static Lit *
+least_occurring_other_literal (Clause * clause, Lit * lit)
 {
-  int delta, was_existential;
-#ifdef QUANTOR_LOG4
-  int idx = v->idx;
-  const char *type = is_existential (v) ? "EXISTS" : "FORALL";
-  LOG (quantor, 4, "%s %d EXPECTS COST %s",
-       type, v->idx, score2str (quantor, expected_cost));
-#else
-  (void) expected_cost;
-#endif
-  assert (v->scope);
-  assert (!v->eliminated);
+  Cell *p, *eor;
+  Lit *res;
 
-  quantor->stats.eliminated_cells = 0;
+  res = 0;
+  eor = end_of_row (clause);
+  for (p = clause->row; p < eor; p++)
+    if (p->lit != lit && (!res || p->lit->column.len < res->column.len))
+      res = p->lit;
 
-  v->eliminated = 1;
-  if (v->eqclass)
-    v->eqclass->num_eliminated++;
+  return res;
+}
 
-  if ((was_existential = is_existential (v)))
-    exists (quantor, v);
-  else
-    forall (quantor, v);
+/*------------------------------------------------------------------------*/
 
-  /************************************/
-  /* NOTE: 'v' may now be invalid !!! */
-  /************************************/
+static void
+mark_bva_clause (Clause * clause, Lit * lit, int mark)
+{
+  Cell *p, *eor;
 
-  delta = quantor->stats.eliminated_cells;
-  assert (quantor->invalid || delta <= expected_cost);
-#ifdef QUANTOR_LOG4
-  LOG (quantor, 4,
-       "%s %d ADDED %d LITERALS (EXPECTED %s)",
-       type, idx, delta, score2str (quantor, expected_cost));
-#endif
-  if (was_existential)
-    save_actual_exists_costs (quantor, delta);
+  eor = end_of_row (clause);
+  for (p = clause->row; p < eor; p++)
+    {
+      if (p->lit == lit)
+	continue;
 
-#ifdef QUANTOR_LOG4
-  LOG (quantor, 4, "SCOPES AFTER ELIMINATION OF VARIABLE %d:", idx);
-#endif
-#ifdef QUANTOR_LOG3
-  log_scopes (quantor, 3);
-#endif
-  check_invariant (quantor, 1);
+      if (mark)
+	p->lit->mark |= 1;
+      else
+	p->lit->mark &= ~1u;
+    }
 }
 
 /*------------------------------------------------------------------------*/
-
-static int
-is_trivial (Quantor * quantor, QuantorResult * res_ptr)
+/* Returns the only literal of 'partner' which is not marked as literal of
+ * the current clause, or zero if there is no such unique literal.
+ */
+static Lit *
+bva_partner_literal (Clause * partner, unsigned *steps_ptr)
 {
-  QuantorResult res;
+  Cell *p, *eor;
+  Lit *res;
 
-  if (quantor->invalid)
-    res = QUANTOR_RESULT_UNSATISFIABLE;
-  else if (!quantor->clauses.len)
-    res = QUANTOR_RESULT_SATISFIABLE;
-  else
-    res = QUANTOR_RESULT_UNKNOWN;
+  res = 0;
+  eor = end_of_row (partner);
+  for (p = partner->row; p < eor; p++)
+    {
+      (*steps_ptr)++;
+      if (p->lit->mark & 1)
+	continue;
 
-  if (res_ptr)
-    *res_ptr = res;
+      if (res)
+	return 0;
 
-  return res != QUANTOR_RESULT_UNKNOWN;
+      res = p->lit;
+    }
+
+  return res;
 }
 
 /*------------------------------------------------------------------------*/
-
-static int
-timeout (Quantor * quantor)
+/* Push pairs of literals 'other' and clauses 'clause' of 'clauses', for
+ * which 'clause' with 'lit' replaced by 'other' is a clause too.
+ */
+static void
+find_bva_pairs (Quantor * quantor, Lit * lit, PtrStack * clauses,
+		PtrStack * pairs, unsigned *steps_ptr)
 {
-  double delta;
-  int res;
+  Clause *clause, *partner;
+  Lit *min, *other;
+  void **p;
+  Cell *q;
 
-  if (quantor->opts.time_limit < 0)
-    return 0;
+  reset_PtrStack (quantor, pairs, 0);
 
-  delta = get_time () - quantor->stats.time;
-  res = (delta >= quantor->opts.time_limit);
+  for (p = clauses->start; p < clauses->top; p++)
+    {
+      clause = *p;
+      min = least_occurring_other_literal (clause, lit);
+      mark_bva_clause (clause, lit, 1);
 
-  return res;
+      for (q = min->column.first; q; q = q->column_link.next)
+	{
+	  partner = q->clause;
+	  if (partner == clause || partner->size != clause->size ||
+	      is_dying_clause (quantor, partner))
+	    continue;
+
+	  other = bva_partner_literal (partner, steps_ptr);
+	  if (!other || other->mark || other == QUANTOR_NOT (lit) ||
+	      is_assigned_var (other->var))
+	    continue;
+
+	  push_PtrStack (quantor, pairs, other);
+	  push_PtrStack (quantor, pairs, clause);
+	}
+
+      mark_bva_clause (clause, lit, 0);
+    }
 }
 
 /*------------------------------------------------------------------------*/
 
 static int
-spaceout (Quantor * quantor)
+bva_reduction (unsigned num_lits, unsigned num_clauses)
 {
-  double mb;
-  int res;
-
-  if (quantor->opts.space_limit < 0)
-    return 0;
-
-  mb = quantor->stats.bytes;
-  mb /= (1 << 20);
-  res = (mb >= quantor->opts.space_limit);
-
-  return res;
+  return (int) (num_lits * num_clauses) - (int) (num_lits + num_clauses);
 }
 
 /*------------------------------------------------------------------------*/
-
-static QuantorResult
-limit_reached (Quantor * quantor)
+/* Kill the clauses of the product and add the factored clauses.
+ */
+static void
+factor_bva_clauses (Quantor * quantor, Scope * scope,
+		    Lit * lit, PtrStack * lits, PtrStack * clauses)
 {
-  if (timeout (quantor))
-    return QUANTOR_RESULT_TIMEOUT;
+  Lit *min, *other, *x;
+  Clause *clause, *partner;
+  unsigned steps;
+  Cell *q, *eor;
+  void **p;
 
-  if (spaceout (quantor))
-    return QUANTOR_RESULT_SPACEOUT;
+  x = var2lit (gen_Var (quantor, scope), 0);
 
-  return QUANTOR_RESULT_UNKNOWN;
-}
+#ifdef QUANTOR_LOG4
+  LOG (quantor, 4,
+       "BVA ON %d WITH %u LITERALS AND %u CLAUSES INTRODUCES VARIABLE %d",
+       lit2int (quantor, lit), count_PtrStack (lits),
+       count_PtrStack (clauses), lit2int (quantor, x));
+#endif
+  INCSTATS1 (quantor->stats.bva_vars);
+#ifdef QUANTOR_STATS1
+  quantor->stats.bva_clauses +=
+    bva_reduction (count_PtrStack (lits), count_PtrStack (clauses));
+#endif
 
-/*------------------------------------------------------------------------*/
+  steps = 0;
+  for (p = clauses->start; p < clauses->top; p++)
+    {
+      clause = *p;
+      min = least_occurring_other_literal (clause, lit);
+      mark_bva_clause (clause, lit, 1);
 
-static QuantorResult trivial_truth (Quantor *);
-static QuantorResult trivial_falsity (Quantor *);
+      for (q = min->column.first; q; q = q->column_link.next)
+	{
+	  partner = q->clause;
+	  if (partner == clause || partner->size != clause->size ||
+	      is_dying_clause (quantor, partner))
+	    continue;
 
-/*------------------------------------------------------------------------*/
+	  other = bva_partner_literal (partner, &steps);
+	  if (other && (other->mark & 2))
+	    kill_Clause (quantor, partner);
+	}
 
-static QuantorResult
-trivial_truth_and_falsity (Quantor * quantor)
-{
-  QuantorResult res;
+      mark_bva_clause (clause, lit, 0);
+      kill_Clause (quantor, clause);
+    }
 
-  res = trivial_truth (quantor);
-  assert (res != QUANTOR_RESULT_UNSATISFIABLE);
-  if (res != QUANTOR_RESULT_UNKNOWN)
-    return res;
+  for (p = lits->start; p < lits->top; p++)
+    ((Lit *) * p)->mark = 0;
 
-  res = trivial_falsity (quantor);
-  assert (res != QUANTOR_RESULT_SATISFIABLE);
+  for (p = clauses->start; p < clauses->top; p++)
+    {
+      clause = *p;
+      push_PtrStack (quantor, &quantor->new_clause, x);
+      eor = end_of_row (clause);
+      for (q = clause->row; q < eor; q++)
+	if (q->lit != lit)
+	  push_PtrStack (quantor, &quantor->new_clause, q->lit);
+      add_new_clause (quantor, "BVA");
+    }
 
-  return res;
+  for (p = lits->start; p < lits->top; p++)
+    {
+      push_PtrStack (quantor, &quantor->new_clause, QUANTOR_NOT (x));
+      push_PtrStack (quantor, &quantor->new_clause, *p);
+      add_new_clause (quantor, "BVA");
+    }
 }
 
 /*------------------------------------------------------------------------*/
-
-static QuantorResult
-inner_quantified_variables_elimination_loop (Quantor * quantor)
+/* Greedily extend the set of factored literals starting with 'lit', as
+ * long as the number of removed clauses grows.  Returns non zero if the
+ * clauses were factored.
+ */
+static int
+bva_on_literal (Quantor * quantor, Scope * scope, Lit * lit,
+		PtrStack * lits, PtrStack * clauses, PtrStack * pairs,
+		unsigned *steps_ptr)
 {
-  QuantorResult res;
-  Var *var;
-  int cost;
+  unsigned count, max_count;
+  Lit *other, *max;
+  Clause *clause;
+  int reduction;
+  void **p;
+  Cell *q;
 
-  for (;;)
-    {
-      bcp (quantor);
+  reset_PtrStack (quantor, lits, 0);
+  reset_PtrStack (quantor, clauses, 0);
 
-      if (is_trivial (quantor, &res))
-	return res;
+  for (q = lit->column.first; q; q = q->column_link.next)
+    if (q->clause->size > 1 && !is_dying_clause (quantor, q->clause))
+      push_PtrStack (quantor, clauses, q->clause);
 
-      if (is_propositional (quantor))
-	return QUANTOR_RESULT_UNKNOWN;
+  push_PtrStack (quantor, lits, lit);
+  lit->mark = 2;
+  reduction = 0;
 
-      if ((res = limit_reached (quantor)) != QUANTOR_RESULT_UNKNOWN)
-	return res;
+  while (*steps_ptr < (unsigned) quantor->opts.bva)
+    {
+      find_bva_pairs (quantor, lit, clauses, pairs, steps_ptr);
 
-      var = pivot (quantor, &cost);
-      if (!var)
-	return QUANTOR_RESULT_UNKNOWN;
+      max = 0;
+      max_count = 0;
+      for (p = pairs->start; p < pairs->top; p += 2)
+	{
+	  other = *p;
+	  count = ++other->mark;
+	  if (count > max_count)
+	    {
+	      max = other;
+	      max_count = count;
+	    }
+	}
 
-      if (is_universal (var))
+      for (p = pairs->start; p < pairs->top; p += 2)
+	((Lit *) * p)->mark = 0;
+
+      if (!max || bva_reduction (count_PtrStack (lits) + 1, max_count)
+	  <= reduction)
+	break;
+
+      /* Duplicated clauses may give the same pair twice.
+       */
+      reset_PtrStack (quantor, clauses, 0);
+      for (p = pairs->start; p < pairs->top; p += 2)
 	{
-	  res = trivial_truth_and_falsity (quantor);
-	  if (res != QUANTOR_RESULT_UNKNOWN)
-	    return res;
+	  clause = p[1];
+	  if (*p == max &&
+	      (clauses->top == clauses->start || clauses->top[-1] != clause))
+	    push_PtrStack (quantor, clauses, clause);
 	}
 
-      eliminate (quantor, var, cost);
+      push_PtrStack (quantor, lits, max);
+      max->mark = 2;
+      reduction = bva_reduction (count_PtrStack (lits),
+				 count_PtrStack (clauses));
     }
+
+  if (reduction > 0)
+    factor_bva_clauses (quantor, scope, lit, lits, clauses);
+
+  for (p = lits->start; p < lits->top; p++)
+    ((Lit *) * p)->mark = 0;
+
+  return reduction > 0;
 }
 
 /*------------------------------------------------------------------------*/
-#ifdef QUANTOR_LOG2
-/*------------------------------------------------------------------------*/
+/* Bounded variable addition on the literals of the innermost scope, if it
+ * is existential and not exported.  The number of visited literals is
+ * limited by '--bva'.  Equivalences found in the added binary clauses are
+ * only substituted by the final BCP, so assigned variables are skipped.
+ */
+static void
+bounded_variable_addition (Quantor * quantor)
+{
+  PtrStack lits, clauses, pairs;
+  IntStack candidates;
+  unsigned steps;
+  Scope *scope;
+  int sign, *p;
+  Lit *lit;
+  Var *v;
 
-#define MAX_WORST 1e12
+  if (!quantor->opts.bva)
+    return;
 
-/*------------------------------------------------------------------------*/
+  bcp (quantor);
+  if (quantor->invalid)
+    return;
 
-static double
-worst_case_number_vars_after_expansion_rec (Quantor * quantor, Scope * scope)
-{
-  Scope *next;
-  double res;
-  unsigned i;
+  scope = quantor->scopes.last;
+  while (scope && is_empty_Scope (scope))
+    scope = scope->link.prev;
 
-  if (!scope)
-    return 0;
+  if (!scope || scope->type != QUANTOR_EXISTENTIAL ||
+      scope->nesting <= quantor->max_external_nesting)
+    return;
 
-  next = scope->link.next;
-  res = worst_case_number_vars_after_expansion_rec (quantor, next);
+  init_PtrStack (quantor, &lits);
+  init_PtrStack (quantor, &clauses);
+  init_PtrStack (quantor, &pairs);
+  memset (&candidates, 0, sizeof (candidates));
 
-  if (scope->type == QUANTOR_EXISTENTIAL)
-    {
-      res += scope->vars.len;
-    }
-  else
-    {
-      for (i = 0; res < MAX_WORST && i < scope->vars.len; i++)
-	res *= 2.0;
-    }
+  /* New variables are added to 'scope' too, so we only remember the
+   * indices of the current ones.
+   */
+  for (v = scope->vars.first; v; v = v->scope_link.next)
+    if (!is_assigned_var (v) && !var_does_not_occur (v))
+      push_IntStack (quantor, &candidates, v->idx);
 
-  if (res >= MAX_WORST)
-    res = MAX_WORST;
+  steps = 0;
+  for (p = candidates.start;
+       p < candidates.top && steps < (unsigned) quantor->opts.bva; p++)
+    {
+      v = quantor->vars.start[*p];
+      assert (v && v->scope == scope);
 
-  return res;
-}
+      for (sign = 0; sign <= 1; sign++)
+	{
+	  lit = var2lit (v, sign);
+	  while (!is_assigned_var (v) && lit->column.len > 2 &&
+		 steps < (unsigned) quantor->opts.bva &&
+		 bva_on_literal (quantor, scope, lit,
+				 &lits, &clauses, &pairs, &steps))
+	    ;
+	}
+    }
 
-/*------------------------------------------------------------------------*/
+#ifdef QUANTOR_LOG2
+  LOG (quantor, 2, "BOUNDED VARIABLE ADDITION VISITED %u LITERALS", steps);
+#endif
+  release_IntStack (quantor, &candidates);
+  release_PtrStack (quantor, &pairs);
+  release_PtrStack (quantor, &clauses);
+  release_PtrStack (quantor, &lits);
 
-static double
-worst_case_number_vars_after_expansion (Quantor * quantor)
-{
-  Scope *first = quantor->scopes.first;
-  return worst_case_number_vars_after_expansion_rec (quantor, first);
+  bcp (quantor);
 }
 
-/*------------------------------------------------------------------------*/
-#endif
 /*------------------------------------------------------------------------*/
 
 static QuantorResult
@@ -11055,6 +14117,11 @@ eliminate_propositional_variables (Quantor * quantor)
 	  break;
 	}
 
+      /* Leave the remaining formula to the SAT solver instead.
+       */
+      if (elimination_exceeds_space_limit (quantor, cost))
+	break;
+
       eliminate (quantor, v, cost);
       bcp (quantor);
 #ifdef QUANTOR_LOG2
@@ -11153,6 +14220,192 @@ assign_not_eliminated_zombies (Quantor * quantor)
 #endif
 }
 
+/*------------------------------------------------------------------------*/
+/* Propagate 'root' over the clauses using 'mark' of the literals as
+ * temporary assignment.  The implied literals, including 'root', are
+ * pushed on 'trail'.  Literals implied by a clause with more than two
+ * literals are also pushed on 'implied', since they give the hyper binary
+ * resolvents '(-root | lit)'.  Visited clauses are counted in '*steps_ptr'.
+ * Returns zero iff 'root' is a failed literal.
+ */
+static int
+propagate_probe (Quantor * quantor, Lit * root,
+		 PtrStack * trail, PtrStack * implied, unsigned *steps_ptr)
+{
+  int res, satisfied, num_unassigned;
+  Lit *lit, *other, *unassigned;
+  Cell *p, *q, *eor;
+  Clause *clause;
+  unsigned i;
+
+  assert (!root->mark);
+  assert (!QUANTOR_NOT (root)->mark);
+
+  root->mark = 1;
+  push_PtrStack (quantor, trail, root);
+  res = 1;
+
+  for (i = 0; res && i < count_PtrStack (trail); i++)
+    {
+      lit = trail->start[i];
+
+      for (p = QUANTOR_NOT (lit)->column.first;
+	   res && p; p = p->column_link.next)
+	{
+	  clause = p->clause;
+	  if (is_dying_clause (quantor, clause))
+	    continue;
+
+	  INCSTATS2 (quantor->stats.probe_steps);
+	  (*steps_ptr)++;
+
+	  satisfied = 0;
+	  num_unassigned = 0;
+	  unassigned = 0;
+
+	  eor = end_of_row (clause);
+	  for (q = clause->row;
+	       !satisfied && num_unassigned < 2 && q < eor; q++)
+	    {
+	      other = q->lit;
+	      if (other->mark)
+		satisfied = 1;
+	      else if (!QUANTOR_NOT (other)->mark)
+		{
+		  unassigned = other;
+		  num_unassigned++;
+		}
+	    }
+
+	  if (satisfied || num_unassigned > 1)
+	    continue;
+
+	  if (!num_unassigned)
+	    {
+#ifdef QUANTOR_LOG5
+	      LOG (quantor, 5, "PROBING %d FALSIFIES CLAUSE %d",
+		   lit2int (quantor, root), clause->idx);
+#endif
+	      res = 0;
+	      continue;
+	    }
+
+	  unassigned->mark = 1;
+	  push_PtrStack (quantor, trail, unassigned);
+
+	  if (clause->size > 2)
+	    push_PtrStack (quantor, implied, unassigned);
+	}
+    }
+
+  return res;
+}
+
+/*------------------------------------------------------------------------*/
+/* Failed literal probing of the remaining propositional formula.  If
+ * propagating a literal falsifies a clause, its negation is added as unit.
+ * Otherwise the hyper binary resolvents of the literals implied by longer
+ * clauses are added, unless they already exist.  They may give new
+ * equivalences in the following BCP, either directly or through
+ * 'decompose'.  The number of visited clauses is limited by '--probe'.
+ */
+static void
+probe (Quantor * quantor)
+{
+  PtrStack trail, implied;
+  int prev_phase, sign, failed;
+  IntStack candidates;
+  unsigned steps;
+  void **p;
+  Lit *lit;
+  int *q;
+  Var *v;
+
+  if (!quantor->opts.probe || quantor->invalid)
+    return;
+
+  assert (is_propositional (quantor));
+
+  prev_phase = enter_phase (quantor, QUANTOR_PHASE_PROBE);
+
+  init_PtrStack (quantor, &trail);
+  init_PtrStack (quantor, &implied);
+  memset (&candidates, 0, sizeof (candidates));
+
+  /* Variables may be removed by BCP after a failed literal.  So we only
+   * remember their indices.
+   */
+  for (p = quantor->vars.start; p < quantor->vars.top; p++)
+    if ((v = *p) && !var_does_not_occur (v))
+      push_IntStack (quantor, &candidates, v->idx);
+
+  steps = 0;
+
+  for (q = candidates.start;
+       !quantor->invalid && q < candidates.top &&
+       steps < (unsigned) quantor->opts.probe; q++)
+    {
+      for (sign = 0; sign <= 1; sign++)
+	{
+	  v = quantor->vars.start[*q];
+	  if (!v || is_assigned_var (v) || var_does_not_occur (v))
+	    break;
+
+	  assert (!is_universal (v));
+
+	  lit = var2lit (v, sign);
+	  if (!QUANTOR_NOT (lit)->column.len)
+	    continue;
+
+	  INCSTATS2 (quantor->stats.probes);
+	  failed = !propagate_probe (quantor, lit, &trail, &implied, &steps);
+
+	  for (p = trail.start; p < trail.top; p++)
+	    ((Lit *) * p)->mark = 0;
+
+	  if (failed)
+	    {
+#ifdef QUANTOR_LOG3
+	      LOG (quantor, 3, "FAILED LITERAL %d", lit2int (quantor, lit));
+#endif
+	      INCSTATS1 (quantor->stats.failed_literals);
+	      push_PtrStack (quantor, &quantor->new_clause, QUANTOR_NOT (lit));
+	      add_new_clause (quantor, "FAILED LITERAL");
+	      bcp (quantor);
+	    }
+	  else
+	    {
+	      for (p = implied.start; p < implied.top; p++)
+		{
+		  if (quantor->opts.equivalences &&
+		      find_implication (quantor, lit, *p))
+		    continue;
+
+		  push_PtrStack (quantor, &quantor->new_clause,
+				 QUANTOR_NOT (lit));
+		  push_PtrStack (quantor, &quantor->new_clause, *p);
+		  if (add_new_clause (quantor, "HYPER BINARY"))
+		    INCSTATS1 (quantor->stats.hyper_binary_resolvents);
+		}
+	    }
+
+	  reset_PtrStack (quantor, &trail, 0);
+	  reset_PtrStack (quantor, &implied, 0);
+	}
+    }
+
+  release_IntStack (quantor, &candidates);
+  release_PtrStack (quantor, &implied);
+  release_PtrStack (quantor, &trail);
+
+#ifdef QUANTOR_LOG2
+  LOG (quantor, 2, "PROBING VISITED %u CLAUSES", steps);
+#endif
+  leave_phase (quantor, prev_phase);
+
+  bcp (quantor);
+}
+
 /*------------------------------------------------------------------------*/
 
 static QuantorResult
@@ -11173,6 +14426,11 @@ propositional_simplification (Quantor * quantor)
 
   bcp (quantor);
 
+  if (is_trivial (quantor, &res))
+    return res;
+
+  probe (quantor);
+
   if (is_trivial (quantor, &res))
     return res;
 
@@ -11573,6 +14831,11 @@ SatSolver_copy (SatSolver * solver, LitIt * it)
       assert (pidx <= solver->max_pidx);
 #endif
       ok = solver->api->add (solver, plit);
+
+      /* Copying stops at the first clause which exceeds the space limit.
+       */
+      if (ok && !plit && spaceout (quantor))
+	ok = 0;
     }
 
   if (quantor->opts.verbose)
@@ -11861,7 +15124,8 @@ static SatSolverAPI funex_api = {
   SatSolverFunEx_delete,
   SatSolverFunEx_add,
   SatSolverFunEx_run,
-  SatSolverFunEx_assignment
+  SatSolverFunEx_assignment,
+  0
 };
 
 /*------------------------------------------------------------------------*/
@@ -12008,7 +15272,8 @@ static SatSolverAPI limmat_api = {
   SatSolverLimmat_delete,
   SatSolverLimmat_add,
   SatSolverLimmat_run,
-  SatSolverLimmat_assignment
+  SatSolverLimmat_assignment,
+  0
 };
 
 /*------------------------------------------------------------------------*/
@@ -12163,7 +15428,8 @@ static SatSolverAPI nanosat_api = {
   SatSolverNanosat_delete,
   SatSolverNanosat_add,
   SatSolverNanosat_run,
-  SatSolverNanosat_assignment
+  SatSolverNanosat_assignment,
+  0
 };
 
 /*------------------------------------------------------------------------*/
@@ -12190,6 +15456,7 @@ struct SatSolverPicosat
 {
   SatSolver super;
   PicoSAT *picosat;
+  IntStack assumptions;		/* repeated for every slice */
 };
 
 /*------------------------------------------------------------------------*/
@@ -12198,6 +15465,74 @@ static SatSolverAPI *SatSolverPicosat_get_api (void);
 
 /*------------------------------------------------------------------------*/
 
+/*------------------------------------------------------------------------*/
+/* PicoSAT allocates its memory through these functions, so that it is
+ * part of the footprint checked against the space limit.
+ */
+static void *
+SatSolverPicosat_malloc (void *state, size_t bytes)
+{
+  Quantor *quantor = state;
+  void *res;
+
+  if (!(res = malloc (bytes)))
+    return 0;
+
+  quantor->stats.sat_bytes += bytes;
+  quantor->stats.blocks++;
+  update_max_footprint (quantor);
+
+  return res;
+}
+
+/*------------------------------------------------------------------------*/
+
+static void
+SatSolverPicosat_free (void *state, void *ptr, size_t bytes)
+{
+  Quantor *quantor = state;
+
+  if (!ptr)
+    return;
+
+  assert (quantor->stats.sat_bytes >= bytes);
+  quantor->stats.sat_bytes -= bytes;
+  assert (quantor->stats.blocks > 0);
+  quantor->stats.blocks--;
+  free (ptr);
+}
+
+/*------------------------------------------------------------------------*/
+
+static void *
+SatSolverPicosat_realloc (void *state, void *ptr,
+			  size_t old_bytes, size_t new_bytes)
+{
+  Quantor *quantor = state;
+  void *res;
+
+  if (!ptr)
+    return SatSolverPicosat_malloc (state, new_bytes);
+
+  if (!new_bytes)
+    {
+      SatSolverPicosat_free (state, ptr, old_bytes);
+      return 0;
+    }
+
+  if (!(res = realloc (ptr, new_bytes)))
+    return 0;
+
+  assert (quantor->stats.sat_bytes >= old_bytes);
+  quantor->stats.sat_bytes -= old_bytes;
+  quantor->stats.sat_bytes += new_bytes;
+  update_max_footprint (quantor);
+
+  return res;
+}
+
+/*------------------------------------------------------------------------*/
+
 static SatSolver *
 SatSolverPicosat_new (Quantor * quantor)
 {
@@ -12209,7 +15544,10 @@ SatSolverPicosat_new (Quantor * quantor)
   if (quantor->opts.verbose >= 2)
     fprintf (quantor->io.out, "c PicoSAT Version %s\n", picosat_version ());
 
-  this->picosat = picosat_init ();
+  this->picosat = picosat_minit (quantor,
+				 SatSolverPicosat_malloc,
+				 SatSolverPicosat_realloc,
+				 SatSolverPicosat_free);
 
   picosat_set_output (this->picosat, quantor->io.out);
   if (quantor->opts.verbose >= 2)
@@ -12217,8 +15555,6 @@ SatSolverPicosat_new (Quantor * quantor)
 
   /* TODO: time limit for picosat */
 
-  /* TODO: space limit for picosat */
-
   return &this->super;
 }
 
@@ -12236,13 +15572,12 @@ SatSolverPicosat_delete (SatSolver * solver)
     picosat_stats (this->picosat);
 
 #ifdef QUANTOR_STATS1
-  quantor->stats.sat_solver_time += picosat_seconds (this->picosat);
-
   bytes = picosat_max_bytes_allocated (this->picosat);
   if (bytes > quantor->stats.sat_solver_bytes)
     quantor->stats.sat_solver_bytes = bytes;
 #endif
   picosat_reset (this->picosat);
+  release_IntStack (quantor, &this->assumptions);
   SatSolver_release (solver);
   delete (quantor, this, sizeof (*this));
 }
@@ -12259,15 +15594,56 @@ SatSolverPicosat_add (SatSolver * solver, int lit)
 
 /*------------------------------------------------------------------------*/
 
+/* Without a space limit PicoSAT runs until it is done.  Otherwise it is
+ * stopped after slices of increasing numbers of decisions to check the
+ * space limit.  Every 'picosat_sat' call restarts the search, which is
+ * why the slices grow.  Assumptions only hold for one 'picosat_sat' call
+ * and have to be repeated for every slice.
+ */
 static QuantorResult
 SatSolverPicosat_run (SatSolver * solver)
 {
   SatSolverPicosat * this = (SatSolverPicosat*) solver;
+  Quantor *quantor = solver->quantor;
+  int picosat_res, decisions;
   QuantorResult res;
-  int picosat_res;
+  int *p;
+#ifdef QUANTOR_STATS1
+  double seconds;
 
-  (void) solver;
-  picosat_res = picosat_sat (this->picosat, -1);
+  /* Accounted per call, since the solver may be reused.
+   */
+  seconds = picosat_seconds (this->picosat);
+#endif
+  if (quantor->opts.space_limit < 0)
+    picosat_res = picosat_sat (this->picosat, -1);
+  else
+    {
+      decisions = QUANTOR_SAT_FIRST_SLICE;
+      for (;;)
+	{
+	  if (spaceout (quantor))
+	    {
+	      picosat_res = PICOSAT_UNKNOWN;
+	      break;
+	    }
+
+	  picosat_res = picosat_sat (this->picosat, decisions);
+	  if (picosat_res != PICOSAT_UNKNOWN)
+	    break;
+
+	  if (decisions < INT_MAX / 2)
+	    decisions *= 2;
+
+	  for (p = this->assumptions.start; p < this->assumptions.top; p++)
+	    picosat_assume (this->picosat, *p);
+	}
+    }
+  reset_IntStack (quantor, &this->assumptions, 0);
+#ifdef QUANTOR_STATS1
+  solver->quantor->stats.sat_solver_time +=
+    picosat_seconds (this->picosat) - seconds;
+#endif
 
   switch (picosat_res)
     {
@@ -12278,7 +15654,10 @@ SatSolverPicosat_run (SatSolver * solver)
       res = QUANTOR_RESULT_UNSATISFIABLE;
       break;
     default:
-      res = QUANTOR_RESULT_UNKNOWN;
+      if (spaceout (quantor))
+	res = QUANTOR_RESULT_SPACEOUT;
+      else
+	res = QUANTOR_RESULT_UNKNOWN;
       break;
     }
 
@@ -12307,13 +15686,25 @@ SatSolverPicosat_assignment (SatSolver * solver)
 
 /*------------------------------------------------------------------------*/
 
+static void
+SatSolverPicosat_assume (SatSolver * solver, int lit)
+{
+  SatSolverPicosat * this = (SatSolverPicosat*) solver;
+  picosat_assume (this->picosat, lit);
+  if (solver->quantor->opts.space_limit >= 0)
+    push_IntStack (solver->quantor, &this->assumptions, lit);
+}
+
+/*------------------------------------------------------------------------*/
+
 static SatSolverAPI picosat_api = {
   "picosat",
   SatSolverPicosat_new,
   SatSolverPicosat_delete,
   SatSolverPicosat_add,
   SatSolverPicosat_run,
-  SatSolverPicosat_assignment
+  SatSolverPicosat_assignment,
+  SatSolverPicosat_assume
 };
 
 /*------------------------------------------------------------------------*/
@@ -12460,7 +15851,8 @@ static SatSolverAPI booleforce_api = {
   SatSolverBooleforce_delete,
   SatSolverBooleforce_add,
   SatSolverBooleforce_run,
-  SatSolverBooleforce_assignment
+  SatSolverBooleforce_assignment,
+  0
 };
 
 /*------------------------------------------------------------------------*/
@@ -12612,7 +16004,8 @@ static SatSolverAPI compsat_api = {
   SatSolverCompsat_delete,
   SatSolverCompsat_add,
   SatSolverCompsat_run,
-  SatSolverCompsat_assignment
+  SatSolverCompsat_assignment,
+  0
 };
 
 /*------------------------------------------------------------------------*/
@@ -12913,25 +16306,157 @@ propagate_sat_solver_assignment (Quantor * quantor, SatSolver * solver)
 
 /*------------------------------------------------------------------------*/
 
+static void
+delete_incremental_sat_solver (Quantor * quantor)
+{
+  SatSolver *solver = quantor->incremental.solver;
+  Clause *c;
+
+  if (!solver)
+    return;
+
+  solver->api->delete (solver);
+  quantor->incremental.solver = 0;
+  quantor->incremental.added = 0;
+  quantor->incremental.retired = 0;
+
+  for (c = quantor->clauses.first; c; c = c->link.next)
+    c->selector = 0;
+}
+
+/*------------------------------------------------------------------------*/
+
+static void
+add_incremental_clause (Quantor * quantor, Clause * clause)
+{
+  SatSolver *solver = quantor->incremental.solver;
+  Cell *p, *eor;
+  Lit *lit;
+
+  assert (!clause->selector);
+  clause->selector = ++solver->max_pidx;
+
+  eor = end_of_row (clause);
+  for (p = clause->row; p < eor; p++)
+    {
+      lit = p->lit;
+      if (!is_existential (lit->var))
+	continue;
+
+      solver->api->add (solver,
+			SatSolver_lit2plit (solver, lit2int (quantor, lit)));
+    }
+
+  solver->api->add (solver, clause->selector);
+  solver->api->add (solver, 0);
+  quantor->incremental.added++;
+}
+
+/*------------------------------------------------------------------------*/
+/* Returns the persistent SAT solver, after adding the existential literals
+ * of all new clauses and assuming all active clauses.  New clauses are
+ * always appended to 'quantor->clauses'.  Thus the clauses not added yet
+ * are found by walking back from the last clause to the last added one.
+ * The solver is rebuilt from scratch if more clauses are disabled than
+ * enabled.
+ */
+static SatSolver *
+incremental_sat_solver (Quantor * quantor)
+{
+  Incremental *incremental = &quantor->incremental;
+  SatSolver *solver;
+  unsigned added;
+  Clause *c;
+
+  assert (quantor->opts.incremental);
+  assert (quantor->sat_api->assume);
+
+  if (incremental->solver &&
+      incremental->retired > incremental->added - incremental->retired)
+    {
+      delete_incremental_sat_solver (quantor);
+      incremental->rebuilt++;
+    }
+
+  if (!incremental->solver)
+    incremental->solver = quantor->sat_api->new (quantor);
+
+  solver = incremental->solver;
+  added = incremental->added;
+
+  for (c = quantor->clauses.last; c && !c->selector; c = c->link.prev)
+    ;
+
+  for (c = c ? c->link.next : quantor->clauses.first; c; c = c->link.next)
+    if (!is_dying_clause (quantor, c))
+      add_incremental_clause (quantor, c);
+
+  for (c = quantor->clauses.first; c; c = c->link.next)
+    if (c->selector && !is_dying_clause (quantor, c))
+      solver->api->assume (solver, -c->selector);
+
+  reset_PtrStack (quantor, &solver->assignment, 0);
+  solver->assignment_initialized = 0;
+
+#ifdef QUANTOR_LOG1
+  LOG (quantor, 1, "INCREMENTAL SAT SOLVER");
+  LOG (quantor, 1, "  %u NEW CLAUSES ADDED", incremental->added - added);
+  LOG (quantor, 1, "  %u CLAUSES RETIRED IN TOTAL", incremental->retired);
+  LOG (quantor, 1, "  %u CLAUSES ACTIVE",
+       incremental->added - incremental->retired);
+  LOG (quantor, 1, "  %u REBUILDS", incremental->rebuilt);
+#else
+  (void) added;
+#endif
+
+  return solver;
+}
+
+/*------------------------------------------------------------------------*/
+
+static int
+use_incremental_sat_solver (Quantor * quantor)
+{
+  return quantor->opts.incremental && quantor->sat_api->assume;
+}
+
+/*------------------------------------------------------------------------*/
+
 static QuantorResult
 sat (Quantor * quantor)
 {
+  int ok, prev_phase;
   SatSolver *solver;
   QuantorResult res;
   LitIt *it;
-  int ok;
 
   assert (quantor->sat_api);
 #ifdef QUANTOR_LOG1
   LOG (quantor, 1, "CALLING EXTERNAL SAT SOLVER ON REMAINING CLAUSES");
 #endif
-  solver = quantor->sat_api->new (quantor);
-  it = AllClausesLitIt_new (quantor, 0);
-  ok = SatSolver_copy (solver, it);
-  it->api->delete (it);
+  prev_phase = enter_phase (quantor, QUANTOR_PHASE_SAT);
+
+  /* Reuse the solver of previous trivial truth checks.  At this point all
+   * remaining variables are existential, so the clauses in this solver
+   * are the same as in a new one.
+   */
+  if (quantor->incremental.solver && use_incremental_sat_solver (quantor))
+    {
+      solver = incremental_sat_solver (quantor);
+      ok = 1;
+    }
+  else
+    {
+      solver = quantor->sat_api->new (quantor);
+      it = AllClausesLitIt_new (quantor, 0);
+      ok = SatSolver_copy (solver, it);
+      it->api->delete (it);
+    }
 
   if (ok)
     res = SatSolver_run (solver);
+  else if (spaceout (quantor))
+    res = QUANTOR_RESULT_SPACEOUT;
   else
     res = QUANTOR_RESULT_UNKNOWN;
 
@@ -12941,7 +16466,9 @@ sat (Quantor * quantor)
       assign_not_eliminated_zombies (quantor);
     }
 
-  quantor->sat_api->delete (solver);
+  if (solver != quantor->incremental.solver)
+    quantor->sat_api->delete (solver);
+  leave_phase (quantor, prev_phase);
 
 #ifdef QUANTOR_STATS2
   assert (!quantor->stats.sat_remaining_time);
@@ -12961,13 +16488,14 @@ trivial_truth (Quantor * quantor)
 #ifdef QUANTOR_STATS2
   double time;
 #endif
+  int ok, prev_phase;
   LitIt *it;
-  int ok;
 
   if (!quantor->opts.trivial_truth)
     return QUANTOR_RESULT_UNKNOWN;
 
   INCSTATS2 (quantor->stats.trivial_truth);
+  prev_phase = enter_phase (quantor, QUANTOR_PHASE_SAT);
   assert (quantor->sat_api);
 #ifdef QUANTOR_STATS2
   time = quantor->stats.sat_solver_time;
@@ -12975,10 +16503,19 @@ trivial_truth (Quantor * quantor)
 #ifdef QUANTOR_LOG2
   LOG (quantor, 2, "CALLING SAT SOLVER FOR TRIVIAL TRUTH");
 #endif
-  solver = quantor->sat_api->new (quantor);
-  it = AllClausesLitIt_new (quantor, 1);
-  ok = SatSolver_copy (solver, it);
-  it->api->delete (it);
+  if (use_incremental_sat_solver (quantor))
+    {
+      solver = incremental_sat_solver (quantor);
+      ok = 1;
+    }
+  else
+    {
+      solver = quantor->sat_api->new (quantor);
+      it = AllClausesLitIt_new (quantor, 1);
+      ok = SatSolver_copy (solver, it);
+      it->api->delete (it);
+    }
+
   if (ok)
     res = SatSolver_run (solver);
   else
@@ -12994,34 +16531,257 @@ trivial_truth (Quantor * quantor)
     }
   else
     {
-#ifdef QUANTOR_LOG1
-      LOG (quantor, 1, "TRIVIAL TRUTH CHECK FAILED");
-#endif
-      res = QUANTOR_RESULT_UNKNOWN;
+#ifdef QUANTOR_LOG1
+      LOG (quantor, 1, "TRIVIAL TRUTH CHECK FAILED");
+#endif
+      res = QUANTOR_RESULT_UNKNOWN;
+    }
+
+  if (solver != quantor->incremental.solver)
+    quantor->sat_api->delete (solver);
+  leave_phase (quantor, prev_phase);
+
+#ifdef QUANTOR_STATS2
+  quantor->stats.sat_trivial_truth_time +=
+    quantor->stats.sat_solver_time - time;
+#endif
+
+  assert (res == QUANTOR_RESULT_UNKNOWN || res == QUANTOR_RESULT_SATISFIABLE);
+
+  return res;
+}
+
+/*------------------------------------------------------------------------*/
+
+static QuantorResult
+trivial_falsity (Quantor * quantor)
+{
+  if (!quantor->opts.trivial_falsity)
+    return QUANTOR_RESULT_UNKNOWN;
+
+  INCSTATS2 (quantor->stats.trivial_falsity);
+  return QUANTOR_RESULT_UNKNOWN;
+}
+
+/*------------------------------------------------------------------------*/
+/* Fallback for running out of memory during elimination.  The remaining
+ * variables are assigned in prefix order by a QDPLL style search, which
+ * uses one SAT solver with assumptions on all remaining clauses,
+ * including universal literals.  If the clauses are unsatisfiable under
+ * the current partial assignment, then the formula is false under it.
+ * Otherwise the model gives the phase to try first: the model value for
+ * existential and its negation for universal variables.  Existential
+ * variables of the innermost scope are left to the SAT solver.  Memory
+ * use is bounded by the SAT solver and the recursion depth.
+ */
+typedef struct Search Search;
+
+struct Search
+{
+  SatSolver *solver;
+  PtrStack vars;		/* branching variables in prefix order */
+  IntStack assumptions;		/* current decisions as solver literals */
+  IntStack model;		/* decisions of the outermost scope */
+  unsigned outermost;		/* number of outermost existential vars */
+  unsigned decisions;
+  unsigned calls;
+};
+
+/*------------------------------------------------------------------------*/
+
+static int
+search_plit (Search * search, Var * v)
+{
+  return SatSolver_lit2plit (search->solver, v->idx);
+}
+
+/*------------------------------------------------------------------------*/
+
+static QuantorResult
+search_assuming_decisions (Quantor * quantor, Search * search)
+{
+  SatSolver *solver = search->solver;
+  int *p;
+
+  for (p = search->assumptions.start; p < search->assumptions.top; p++)
+    solver->api->assume (solver, *p);
+
+  reset_PtrStack (quantor, &solver->assignment, 0);
+  solver->assignment_initialized = 0;
+  search->calls++;
+
+  return SatSolver_run (solver);
+}
+
+/*------------------------------------------------------------------------*/
+
+static QuantorResult
+search_rec (Quantor * quantor, Search * search, unsigned level)
+{
+  int universal, plit, phase, i;
+  SatSolver *solver;
+  QuantorResult res;
+  Var *v;
+
+  if (timeout (quantor))
+    return QUANTOR_RESULT_TIMEOUT;
+
+  res = search_assuming_decisions (quantor, search);
+
+  if (res == QUANTOR_RESULT_SATISFIABLE &&
+      level < count_PtrStack (&search->vars))
+    {
+      solver = search->solver;
+      v = search->vars.start[level];
+      universal = is_universal (v);
+      plit = search_plit (search, v);
+
+      if (!solver->assignment_initialized)
+	solver->api->assignment (solver);
+
+      phase = (solver->assignment.start[plit] == QUANTOR_TRUE) ? 1 : -1;
+      if (universal)
+	phase = -phase;
+
+      for (i = 0; i < 2; i++, phase = -phase)
+	{
+	  search->decisions++;
+	  push_IntStack (quantor, &search->assumptions, phase * plit);
+	  res = search_rec (quantor, search, level + 1);
+	  pop_IntStack (&search->assumptions);
+
+	  if (universal && res != QUANTOR_RESULT_SATISFIABLE)
+	    break;
+
+	  if (!universal && res != QUANTOR_RESULT_UNSATISFIABLE)
+	    break;
+	}
+    }
+
+  /* All decisions above this level are existential.  Thus a satisfying
+   * result at this level is propagated to the root without further
+   * decisions and the outermost decisions can be saved here.
+   */
+  if (res == QUANTOR_RESULT_SATISFIABLE && level == search->outermost)
+    {
+      assert (count_IntStack (&search->assumptions) == level);
+      reset_IntStack (quantor, &search->model, 0);
+      for (i = 0; i < (int) level; i++)
+	push_IntStack (quantor, &search->model, search->assumptions.start[i]);
+    }
+
+  return res;
+}
+
+/*------------------------------------------------------------------------*/
+
+static void
+init_search_vars (Quantor * quantor, Search * search)
+{
+  Scope *scope, *innermost;
+  int outermost;
+  Var *v;
+
+  innermost = quantor->scopes.last;
+  while (innermost && is_empty_Scope (innermost))
+    innermost = innermost->link.prev;
+
+  if (innermost && innermost->type != QUANTOR_EXISTENTIAL)
+    innermost = 0;
+
+  outermost = 1;
+  for (scope = quantor->scopes.first;
+       scope && scope != innermost; scope = scope->link.next)
+    {
+      if (scope->type == QUANTOR_UNIVERSAL && !is_empty_Scope (scope))
+	outermost = 0;
+
+      for (v = scope->vars.first; v; v = v->scope_link.next)
+	{
+	  if (is_assigned_var (v) || v->eliminated || var_does_not_occur (v))
+	    continue;
+
+	  push_PtrStack (quantor, &search->vars, v);
+	  if (outermost)
+	    search->outermost++;
+	}
     }
+}
+
+/*------------------------------------------------------------------------*/
 
-  quantor->sat_api->delete (solver);
+static void
+assign_search_model (Quantor * quantor, Search * search)
+{
+  int *p, plit;
+  Var *v;
 
-#ifdef QUANTOR_STATS2
-  quantor->stats.sat_trivial_truth_time +=
-    quantor->stats.sat_solver_time - time;
-#endif
+  for (p = search->model.start; p < search->model.top; p++)
+    {
+      plit = *p;
+      v = search->vars.start[p - search->model.start];
+      assert (search_plit (search, v) == abs (plit));
 
-  assert (res == QUANTOR_RESULT_UNKNOWN || res == QUANTOR_RESULT_SATISFIABLE);
+      if (v->exported && !is_assigned_var (v))
+	assign (quantor, v, (plit > 0) ? QUANTOR_TRUE : QUANTOR_FALSE);
+    }
 
-  return res;
+  assign_not_eliminated_zombies (quantor);
 }
 
 /*------------------------------------------------------------------------*/
 
 static QuantorResult
-trivial_falsity (Quantor * quantor)
+search (Quantor * quantor)
 {
-  if (!quantor->opts.trivial_falsity)
-    return QUANTOR_RESULT_UNKNOWN;
+  int ok, prev_phase;
+  QuantorResult res;
+  Search search;
+  LitIt *it;
 
-  INCSTATS2 (quantor->stats.trivial_falsity);
-  return QUANTOR_RESULT_UNKNOWN;
+  assert (quantor->sat_api);
+
+  if (is_propositional (quantor))
+    return sat (quantor);
+
+  if (!quantor->sat_api->assume)
+    return QUANTOR_RESULT_SPACEOUT;
+
+  report (quantor,
+	  "search on remaining %u clauses after %.1f MB allocated",
+	  quantor->clauses.len, quantor->stats.bytes / (double) (1 << 20));
+
+  prev_phase = enter_phase (quantor, QUANTOR_PHASE_SAT);
+  delete_incremental_sat_solver (quantor);
+
+  memset (&search, 0, sizeof (search));
+  init_search_vars (quantor, &search);
+  search.solver = quantor->sat_api->new (quantor);
+  it = AllClausesLitIt_new (quantor, 0);
+  ok = SatSolver_copy (search.solver, it);
+  it->api->delete (it);
+
+  if (ok)
+    res = search_rec (quantor, &search, 0);
+  else if (spaceout (quantor))
+    res = QUANTOR_RESULT_SPACEOUT;
+  else
+    res = QUANTOR_RESULT_UNKNOWN;
+
+  if (res == QUANTOR_RESULT_SATISFIABLE)
+    assign_search_model (quantor, &search);
+
+  report (quantor,
+	  "search: %u variables, %u decisions, %u SAT solver calls",
+	  count_PtrStack (&search.vars), search.decisions, search.calls);
+
+  quantor->sat_api->delete (search.solver);
+  release_PtrStack (quantor, &search.vars);
+  release_IntStack (quantor, &search.assumptions);
+  release_IntStack (quantor, &search.model);
+  leave_phase (quantor, prev_phase);
+
+  return res;
 }
 
 /*------------------------------------------------------------------------*/
@@ -13034,8 +16794,8 @@ lift_assignment_to_original_clauses (Quantor * quantor)
 #ifdef QUANTOR_STATS2
   double time;
 #endif
+  int i, ok, prev_phase;
   LitIt *it;
-  int i, ok;
   Lit *tmp;
   Var *v;
 
@@ -13046,6 +16806,7 @@ lift_assignment_to_original_clauses (Quantor * quantor)
 #ifdef QUANTOR_LOG1
   LOG (quantor, 1, "CALLING EXTERNAL SAT SOLVER ON ORIGINAL CLAUSES");
 #endif
+  prev_phase = enter_phase (quantor, QUANTOR_PHASE_LIFT);
   solver = quantor->sat_api->new (quantor);
   it = IntStackLitIt_new (quantor, &quantor->dead_original_clauses);
   ok = SatSolver_copy (solver, it);
@@ -13080,6 +16841,7 @@ lift_assignment_to_original_clauses (Quantor * quantor)
     res = QUANTOR_RESULT_UNKNOWN;
 
   solver->api->delete (solver);
+  leave_phase (quantor, prev_phase);
 #ifdef QUANTOR_STATS2
   assert (!quantor->stats.sat_original_time);
   quantor->stats.sat_original_time = quantor->stats.sat_solver_time - time;
@@ -13230,6 +16992,9 @@ delete_Quantor (Quantor * quantor)
   release_IntStack (quantor, &quantor->external_literals);
   release_IntStack (quantor, &quantor->external_scope);
   release_PtrStack (quantor, &quantor->new_clause);
+  release_PtrStack (quantor, &quantor->occurrences);
+  release_PtrStack (quantor, &quantor->fresh_lits);
+  delete_incremental_sat_solver (quantor);
   release_PtrStack (quantor, &quantor->new_rhs);
   release_clauses (quantor);
   release_IntStack (quantor, &quantor->dead_original_clauses);
@@ -13254,9 +17019,11 @@ delete_Quantor (Quantor * quantor)
   release_IntStack (quantor, &quantor->free_clause_indices);
   release_PtrStack (quantor, &quantor->marked_vars);
   release_IntStack (quantor, &quantor->external_assignment);
+  release_IntStack (quantor, &quantor->external_prefix);
   release_opts (quantor);
   release_environment (quantor);
   delete_string (quantor, quantor->prefix);
+  close_input (quantor);
 #ifdef QUANTOR_FAST_ALLOC
   release_chunks (quantor);
 #endif
@@ -13264,12 +17031,6 @@ delete_Quantor (Quantor * quantor)
   if (quantor->io.close_out)
     fclose (quantor->io.out);
 
-  if (quantor->io.close_in)
-    fclose (quantor->io.in);
-
-  if (quantor->io.pclose_in)
-    pclose (quantor->io.in);
-
   assert (getenv ("LEAK") || !quantor->stats.bytes);
 
   free (quantor);
@@ -13691,6 +17452,7 @@ banner (Quantor * quantor)
 "  -o <out-file>             set output file\n" \
 "  --<solver>                specify SAT solver for propositional part\n" \
 "  --list-sat-solvers        list valid SAT solver names\n" \
+"  --list-strategies         list strategies for '--strategy=<n>'\n" \
 "  --undocumented            list undocumented command line options\n" \
 "  -D<name>=<val>            set environment variable <name> to <val>\n" \
 "\n" \
@@ -13763,12 +17525,37 @@ log_count_stats (Quantor * quantor, int level,
 #endif
 /*------------------------------------------------------------------------*/
 
+static const char *phase_names[QUANTOR_NUM_PHASES] = {
+  "parse",
+  "bcp",
+  "forward_subsume",
+  "exists",
+  "forall",
+  "sat",
+  "lift",
+  "probe",
+};
+
+/*------------------------------------------------------------------------*/
+
+const char *
+quantor_phase_name (QuantorPhase phase)
+{
+  assert (0 <= phase && phase < QUANTOR_NUM_PHASES);
+  return phase_names[phase];
+}
+
+/*------------------------------------------------------------------------*/
+
 void
 quantor_stats (Quantor * quantor, FILE * file)
 {
   FILE * saved_out;
   Stats *stats;
   double delta;
+#ifdef QUANTOR_LOG2
+  int phase;
+#endif
 
   saved_out = quantor->io.out;
   quantor->io.out = file;
@@ -13812,6 +17599,8 @@ quantor_stats (Quantor * quantor, FILE * file)
   LOG (quantor, 1, "EQUIVALENCES %.0f", stats->equivalences);
 #ifdef QUANTOR_STATS2
   LOG (quantor, 2, "  FROMFUN=%.0f", stats->equivalences_from_functions);
+  LOG (quantor, 2, "  FROMSCC=%.0f IN %.0f DECOMPOSITIONS",
+       stats->equivalences_from_sccs, stats->decompositions);
 #endif
 #endif
 #ifdef QUANTOR_LOG2
@@ -13830,6 +17619,21 @@ quantor_stats (Quantor * quantor, FILE * file)
   LOG (quantor, 2, "    EXTRACTIONS/LHSCHECKS=%.2f",
        (stats->or_extractions.checks > 0) ?
        stats->or_lhs.checks / stats->or_extractions.checks : 0);
+  log_count_stats (quantor, 2, "ITE", &stats->ite);
+  log_count_stats (quantor, 2, "XOR", &stats->xor);
+  log_cache_stats (quantor, 2, "ITEXOREXTRACTIONS",
+		   &stats->gate_extractions);
+#endif
+#endif
+#if defined(QUANTOR_LOG1) && defined(QUANTOR_STATS1)
+  LOG (quantor, 1, "BLOCKED CLAUSES %.0f", stats->blocked_clauses);
+  LOG (quantor, 1, "BVA VARIABLES %.0f REMOVING %.0f CLAUSES",
+       stats->bva_vars, stats->bva_clauses);
+  LOG (quantor, 1, "FAILED LITERALS %.0f", stats->failed_literals);
+  LOG (quantor, 1, "  HYPERBINARY=%.0f", stats->hyper_binary_resolvents);
+#ifdef QUANTOR_STATS2
+  LOG (quantor, 2, "  PROBES=%.0f STEPS=%.0f",
+       stats->probes, stats->probe_steps);
 #endif
 #endif
 #ifdef QUANTOR_LOG2
@@ -13851,6 +17655,8 @@ quantor_stats (Quantor * quantor, FILE * file)
 #ifdef QUANTOR_STATS2
   LOG (quantor, 2, "  ROUNDS=%.0f AVG=%.1f", stats->bcp_rounds,
        (stats->bcps > 0) ? stats->bcp_rounds / stats->bcps : 0);
+  LOG (quantor, 2, "  STEPS=%.0f INTERRUPTED=%.0f",
+       stats->bcp_steps, stats->bcp_interrupted);
   LOG (quantor, 2, "UNITS %.0f", stats->units);
   LOG (quantor, 2, "UNATES %.0f", stats->unates);
   LOG (quantor, 2, "SUBSTITUTIONS %.0f", stats->substitutions);
@@ -13876,6 +17682,8 @@ quantor_stats (Quantor * quantor, FILE * file)
   LOG (quantor, 2, "  FW=%.0f BW=%.0f SAME=%.0f",
        stats->forward_subsumed, stats->backward_subsumed,
        stats->already_exists);
+  LOG (quantor, 2, "  FWROUNDS=%.0f FWSWEEPS=%.0f",
+       stats->forward_subsume_rounds, stats->forward_subsume_sweeps);
   log_cache_stats (quantor, 2, "SUBSUMECHECKS", &stats->subsume);
 #ifndef NSTRENGTHEN
   LOG (quantor, 2, "STRENGTHEN %.0f",
@@ -13909,8 +17717,17 @@ quantor_stats (Quantor * quantor, FILE * file)
 #endif
 #endif
 #endif
+#ifdef QUANTOR_LOG2
+  for (phase = 0; phase < QUANTOR_NUM_PHASES; phase++)
+    LOG (quantor, 2, "  PHASE %s %.2f SECONDS %.0f CALLS",
+	 phase_names[phase], stats->phase_seconds[phase],
+	 stats->phase_count[phase]);
+#endif
 #ifdef QUANTOR_LOG1
   LOG (quantor, 1, "MB %.1f", stats->max_bytes / (double) (1 << 20));
+  LOG (quantor, 1, "FOOTPRINT MB %.1f",
+       stats->max_footprint / (double) (1 << 20));
+  LOG (quantor, 1, "RSS MB %.1f", get_max_rss () / (double) (1 << 20));
 #endif
 #ifdef QUANTOR_LOG2
 #ifdef QUANTOR_STATS1
@@ -13920,10 +17737,72 @@ quantor_stats (Quantor * quantor, FILE * file)
 #ifdef QUANTOR_STATS2
   LOG (quantor, 2, "  CHUNKS=%u", stats->num_chunks);
 #endif
+#ifdef QUANTOR_STATS1
+  LOG (quantor, 2, "  COMPACTIONS=%u MOVED=%.0f RELEASED=%.1f",
+       stats->compactions, stats->moved_clauses,
+       stats->released_bytes / (double) (1 << 20));
+#endif
 #endif
   quantor->io.out = saved_out;
 }
 
+/*------------------------------------------------------------------------*/
+
+void
+quantor_get_stats (Quantor * quantor, QuantorStats * res)
+{
+  Stats *stats;
+  double delta;
+
+  stats = &quantor->stats;
+  memset (res, 0, sizeof (*res));
+
+#ifdef QUANTOR_STATS1
+  res->exists = stats->exists;
+  res->foralls = stats->foralls;
+  res->units = stats->units;
+  res->unates = stats->unates;
+  res->bcps = stats->bcps;
+  res->subsumed = stats->forward_subsumed + stats->backward_subsumed;
+#ifdef QUANTOR_STATS2
+  res->subsumed += stats->already_exists;
+#endif
+  res->equivalences = stats->equivalences;
+  res->functions = stats->functions.new;
+
+  res->vars = stats->vars.num;
+  res->max_vars = stats->vars.max;
+  res->clauses = stats->clauses.num;
+  res->max_clauses = stats->clauses.max;
+  res->literals = stats->cells.num;
+  res->max_literals = stats->cells.max;
+
+  res->sat_solver_bytes = stats->sat_solver_bytes;
+  res->sat_solver_seconds = stats->sat_solver_time;
+#endif
+  res->bytes = stats->bytes;
+  res->max_bytes = stats->max_bytes;
+  res->footprint = footprint (quantor);
+  res->max_footprint = stats->max_footprint;
+  res->max_rss = get_max_rss ();
+
+  delta = get_time () - stats->time;
+  res->seconds = (delta >= 0) ? delta : 0;
+
+  memcpy (res->phase_seconds, stats->phase_seconds,
+	  sizeof (res->phase_seconds));
+  memcpy (res->phase_count, stats->phase_count, sizeof (res->phase_count));
+
+  /* Include the running time of the active phase, if any.
+   */
+  if (stats->phase != QUANTOR_NO_PHASE)
+    {
+      delta = get_monotonic_time () - stats->phase_entered;
+      if (delta > 0)
+	res->phase_seconds[stats->phase] += delta;
+    }
+}
+
 /*------------------------------------------------------------------------*/
 #ifdef QUANTOR_CHECK
 /*------------------------------------------------------------------------*/
@@ -14129,6 +18008,42 @@ white (void)
 
 /*------------------------------------------------------------------------*/
 #endif
+/*------------------------------------------------------------------------*/
+/* Only existential variables of the innermost scopes are eliminated and
+ * only as long as this does not add literals.  Exported variables are
+ * kept, since their values are needed to reconstruct an assignment.
+ */
+static QuantorResult
+preprocess (Quantor * quantor, int budget)
+{
+  QuantorResult res;
+  int cost;
+  Var *v;
+
+  forward_subsume (quantor);
+
+  while (!is_trivial (quantor, &res) && budget)
+    {
+      if ((res = limit_reached (quantor)) != QUANTOR_RESULT_UNKNOWN)
+	break;
+
+      v = cheapest_existential (quantor, &cost, "PREPROCESSING");
+      if (v->exported || cost > 0)
+	break;
+
+      eliminate (quantor, v, cost);
+      bcp (quantor);
+
+      if (budget > 0)
+	budget--;
+    }
+
+  if (res == QUANTOR_RESULT_SATISFIABLE)
+    assign_not_eliminated_zombies (quantor);
+
+  return res;
+}
+
 /*------------------------------------------------------------------------*/
 
 static QuantorResult
@@ -14137,7 +18052,11 @@ quantor_simplify (Quantor * quantor)
   QuantorResult res = QUANTOR_RESULT_UNKNOWN;
 
   if (!quantor->original_problem_is_propositional)
-    res = eliminate_inner_quantified_variables (quantor);
+    {
+      eliminate_blocked_clauses (quantor);
+      bounded_variable_addition (quantor);
+      res = eliminate_inner_quantified_variables (quantor);
+    }
 
   if (res == QUANTOR_RESULT_UNKNOWN && is_propositional (quantor))
     res = propositional_simplification (quantor);
@@ -14150,6 +18069,21 @@ quantor_simplify (Quantor * quantor)
 
 /*------------------------------------------------------------------------*/
 
+static void
+trace_result (Quantor * quantor, QuantorResult res)
+{
+  double seconds;
+
+  seconds = get_time () - quantor->stats.time;
+  report (quantor,
+	  "trace %s result %d eliminations %u %.1f MB %.2f seconds",
+	  get_strategy (quantor)->name, res, quantor->progress.eliminations,
+	  quantor->stats.max_bytes / (double) (1 << 20),
+	  (seconds > 0) ? seconds : 0);
+}
+
+/*------------------------------------------------------------------------*/
+
 static QuantorResult
 quantor_sat_after_simplification (Quantor * quantor, QuantorResult res)
 {
@@ -14171,9 +18105,11 @@ quantor_sat_after_simplification (Quantor * quantor, QuantorResult res)
 	  if (res != QUANTOR_RESULT_SATISFIABLE)
 	    report (quantor, "(failed to lift assignment)");
 	}
-
     }
 
+  if (quantor->opts.trace)
+    trace_result (quantor, res);
+
   return res;
 }
 
@@ -14256,14 +18192,12 @@ quantor_print_solution (Quantor * quantor,
 #endif
 /*------------------------------------------------------------------------*/
 
-#define GUNZIP "gunzip -c %s"
-
 int
 quantor_main (int argc, char **argv)
 {
   int pretty_print_only, dump_sat, quit_after_simplification;
   int do_not_print_assignment, stats_printed;
-  int i, err, done, fast_exit;
+  int i, j, err, done, fast_exit;
   SatSolverAPI **sat_api_ptr;
   const char *err_str;
   QuantorResult res;
@@ -14438,6 +18372,12 @@ quantor_main (int argc, char **argv)
 	    fprintf (quantor->io.out, "%s\n", (*sat_api_ptr)->name);
 	  done = 1;
 	}
+      else if (!strcmp (argv[i], "--list-strategies"))
+	{
+	  for (j = 0; j < QUANTOR_NUM_STRATEGIES; j++)
+	    fprintf (quantor->io.out, "%d %s\n", j, strategies[j].name);
+	  done = 1;
+	}
       else if (argv[i][0] == '-' && argv[i][1] == 'D')
 	{
 	  /* skip, since it has been handled above */
@@ -14486,26 +18426,15 @@ quantor_main (int argc, char **argv)
 		   "*** quantor: invalid option '%s' (try '-h')\n", argv[i]);
 	  err = 1;
 	}
-      else if (strstr (argv[i], ".gz") &&
-	       strlen (strstr (argv[i], ".gz")) == 3)
+      else if (decompressor (argv[i]))
 	{
-	  int len = strlen (argv[i]) + strlen (GUNZIP);
-	  char * cmd = new (quantor, len);
-
-	  sprintf (cmd, GUNZIP, argv[i]);
-	  file = popen (cmd, "r");
-	  delete (quantor, cmd, len);
+	  close_input (quantor);
+	  quantor->io.in_name = argv[i];
 
-	  if (file)
-	    {
-	      quantor->io.in = file;
-	      quantor->io.in_name = argv[i];
-	      quantor->io.pclose_in = 1;
-	    }
-	  else
+	  if (!open_compressed_input (quantor, argv[i]))
 	    {
 	      fprintf (quantor->io.out,
-		       "*** quantor: could not gunzip '%s'\n", argv[i]);
+		       "*** quantor: could not decompress '%s'\n", argv[i]);
 	      err = 1;
 	    }
 	}
@@ -14517,9 +18446,7 @@ quantor_main (int argc, char **argv)
 	}
       else
 	{
-	  if (quantor->io.close_in)
-	    fclose (quantor->io.in);
-
+	  close_input (quantor);
 	  quantor->io.in = file;
 	  quantor->io.in_name = argv[i];
 	  quantor->io.close_in = 1;
@@ -14538,6 +18465,16 @@ quantor_main (int argc, char **argv)
       err = 1;
     }
 
+  if (!err &&
+      (quantor->opts.strategy < 0 ||
+       quantor->opts.strategy >= QUANTOR_NUM_STRATEGIES))
+    {
+      fprintf (quantor->io.out,
+	       "*** quantor: invalid strategy %d (try '--list-strategies')\n",
+	       quantor->opts.strategy);
+      err = 1;
+    }
+
   /* Now we are done with parsing command line options and environment
    * variables and setting options accordingly.
    */
@@ -14631,6 +18568,26 @@ quantor_delete (Quantor * quantor)
 
 /*------------------------------------------------------------------------*/
 
+void *
+quantor_set_progress (Quantor * quantor, int interval,
+		      QuantorProgressCallback callback, void *state)
+{
+  Progress *progress = &quantor->progress;
+  void *res = progress->state;
+
+  if (interval <= 0)
+    callback = 0;
+
+  progress->callback = callback;
+  progress->state = callback ? state : 0;
+  progress->interval = callback ? interval : 0;
+  progress->next = progress->eliminations + progress->interval;
+
+  return res;
+}
+
+/*------------------------------------------------------------------------*/
+
 const char *
 quantor_copyright (void)
 {
@@ -14666,3 +18623,141 @@ quantor_sat (Quantor * quantor)
   return res;
 }
 
+/*------------------------------------------------------------------------*/
+
+QuantorResult
+quantor_preprocess (Quantor * quantor, int budget)
+{
+  return preprocess (quantor, budget);
+}
+
+/*------------------------------------------------------------------------*/
+
+const int *
+quantor_scope_vars (Quantor * quantor, int i,
+		    QuantorQuantificationType * type_ptr)
+{
+  Scope *scope;
+  Var *v;
+
+  for (scope = first_non_empty_scope (quantor);
+       scope && i > 0; scope = next_non_empty_scope (scope))
+    i--;
+
+  if (!scope || i < 0)
+    return 0;
+
+  reset_IntStack (quantor, &quantor->external_prefix, 0);
+
+  for (v = scope->vars.first; v; v = v->scope_link.next)
+    {
+      if (is_assigned_var (v) || v->eliminated || var_does_not_occur (v))
+	continue;
+
+      push_IntStack (quantor, &quantor->external_prefix, v->idx);
+    }
+
+  push_IntStack (quantor, &quantor->external_prefix, 0);
+
+  if (type_ptr)
+    *type_ptr = (scope->type == QUANTOR_UNIVERSAL) ?
+      QUANTOR_UNIVERSAL_VARIABLE_TYPE : QUANTOR_EXISTENTIAL_VARIABLE_TYPE;
+
+  return quantor->external_prefix.start;
+}
+
+/*------------------------------------------------------------------------*/
+
+struct QuantorClauseIt
+{
+  Quantor *quantor;
+  LitIt *it;
+};
+
+/*------------------------------------------------------------------------*/
+
+QuantorClauseIt *
+quantor_clause_it_new (Quantor * quantor)
+{
+  QuantorClauseIt *res;
+
+  res = new (quantor, sizeof (*res));
+  res->quantor = quantor;
+  res->it = AllClausesLitIt_new (quantor, 0);
+
+  return res;
+}
+
+/*------------------------------------------------------------------------*/
+
+int
+quantor_clause_it_next (QuantorClauseIt * clause_it, int *lit_ptr)
+{
+  if (clause_it->quantor->invalid)
+    return 0;
+
+  return !clause_it->it->api->done (clause_it->it, lit_ptr);
+}
+
+/*------------------------------------------------------------------------*/
+
+void
+quantor_clause_it_delete (QuantorClauseIt * clause_it)
+{
+  clause_it->it->api->delete (clause_it->it);
+  delete (clause_it->quantor, clause_it, sizeof (*clause_it));
+}
+
+/*------------------------------------------------------------------------*/
+
+QuantorResult
+quantor_reconstruct (Quantor * quantor, const int *assignment)
+{
+  int lit, idx, num_vars, *val;
+  IntStack values;
+  const int *p;
+  Lit *tmp;
+  Var *v;
+
+  if (quantor->invalid)
+    return QUANTOR_RESULT_UNSATISFIABLE;
+
+  memset (&values, 0, sizeof (values));
+  num_vars = count_PtrStack (&quantor->vars);
+
+  for (p = assignment; (lit = *p); p++)
+    {
+      idx = abs (lit);
+      if (idx < num_vars)
+	*access_IntStack (quantor, &values, idx) = (lit < 0) ? -1 : 1;
+    }
+
+  for (idx = 1; idx <= quantor->max_idx; idx++)
+    {
+      v = quantor->vars.start[idx];
+      if (!v || !v->exported || v->eliminated || v->zombie)
+	continue;
+
+      tmp = deref (quantor, var2lit (v, 0));
+      if (is_constant (tmp))
+	continue;
+
+      if (tmp->var->idx >= (int) count_IntStack (&values))
+	continue;
+
+      val = values.start + tmp->var->idx;
+      if (!*val)
+	continue;
+
+      if (QUANTOR_SIGN (tmp) ? *val < 0 : *val > 0)
+	assign (quantor, v, QUANTOR_TRUE);
+      else
+	assign (quantor, v, QUANTOR_FALSE);
+    }
+
+  assign_not_eliminated_zombies (quantor);
+  release_IntStack (quantor, &values);
+
+  return QUANTOR_RESULT_SATISFIABLE;
+}
+
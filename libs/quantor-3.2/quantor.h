@@ -95,6 +95,103 @@ QuantorResult quantor_sat (Quantor *);
 void quantor_print (Quantor *, FILE *);
 void quantor_stats (Quantor *, FILE *);
 
+/*------------------------------------------------------------------------*/
+/* Phases of the solver with their own timer and call counter.  Time spent
+ * in a nested phase, e.g. BCP after forall expansion, is only accounted
+ * for in the nested phase.
+ */
+enum QuantorPhase
+{
+  QUANTOR_PHASE_PARSE = 0,
+  QUANTOR_PHASE_BCP = 1,
+  QUANTOR_PHASE_FORWARD_SUBSUME = 2,
+  QUANTOR_PHASE_EXISTS = 3,
+  QUANTOR_PHASE_FORALL = 4,
+  QUANTOR_PHASE_SAT = 5,
+  QUANTOR_PHASE_LIFT = 6,
+  QUANTOR_PHASE_PROBE = 7,
+};
+
+#define QUANTOR_NUM_PHASES 8
+
+typedef enum QuantorPhase QuantorPhase;
+
+const char * quantor_phase_name (QuantorPhase);
+
+/*------------------------------------------------------------------------*/
+/* Snapshot of the statistics printed by 'quantor_stats'.  Counters which
+ * depend on statistics code that was not compiled in (see '--stats=<level>'
+ * of 'configure') are reported as zero.
+ */
+typedef struct QuantorStats QuantorStats;
+
+struct QuantorStats
+{
+  double exists;		/* eliminated existential variables */
+  double foralls;		/* expanded universal variables */
+  double units;
+  double unates;
+  double bcps;
+  double subsumed;		/* forward and backward subsumed clauses */
+  double equivalences;
+  double functions;		/* extracted functions */
+
+  unsigned vars, max_vars;
+  unsigned clauses, max_clauses;
+  unsigned literals, max_literals;
+
+  size_t bytes, max_bytes;
+  size_t sat_solver_bytes;	/* maximum over all SAT solver calls */
+
+  /* The space limit is checked against the footprint, which adds the
+   * memory currently allocated by PicoSAT and an estimated 'malloc'
+   * overhead per block to 'bytes'.
+   */
+  size_t footprint, max_footprint;
+  size_t max_rss;		/* of the process, zero if unknown */
+
+  double seconds;		/* since 'quantor_new' */
+  double sat_solver_seconds;
+
+  double phase_seconds[QUANTOR_NUM_PHASES];	/* wall clock */
+  double phase_count[QUANTOR_NUM_PHASES];
+};
+
+void quantor_get_stats (Quantor *, QuantorStats *);
+
+/*------------------------------------------------------------------------*/
+/* Snapshot of the remaining formula passed to a progress callback.
+ */
+typedef struct QuantorProgress QuantorProgress;
+
+struct QuantorProgress
+{
+  unsigned eliminations;	/* variables eliminated so far */
+  unsigned vars;		/* remaining variables */
+  unsigned clauses;		/* remaining clauses */
+  unsigned literals;		/* remaining literal occurrences (cells) */
+  size_t bytes;			/* currently allocated */
+  double seconds;		/* since 'quantor_new' */
+};
+
+/* A progress callback returns 'QUANTOR_RESULT_UNKNOWN' to continue.
+ * Returning 'QUANTOR_RESULT_TIMEOUT' or 'QUANTOR_RESULT_SPACEOUT' aborts
+ * 'quantor_sat', which then returns this result.  Any other result is
+ * treated as 'QUANTOR_RESULT_TIMEOUT'.
+ */
+typedef QuantorResult (*QuantorProgressCallback) (void *state,
+						   const QuantorProgress *);
+
+/*------------------------------------------------------------------------*/
+/* Register a callback which is called every 'interval' eliminations of
+ * quantified or propositional variables, at the point where the time and
+ * space limits are checked.  A zero callback or non positive 'interval'
+ * disables progress reporting.  The result is the previously registered
+ * 'state', so that the caller can release it.
+ */
+void * quantor_set_progress (Quantor *, int interval,
+                             QuantorProgressCallback, void *state);
+
 /*------------------------------------------------------------------------*/
 /* Start a new quantifier scope. This is only allowed before any clause is
  * added.  The variables of a scope are added with 'quantor_add'.  The scope
@@ -112,6 +209,61 @@ const char * quantor_scope (Quantor *, QuantorQuantificationType);
  */
 const char * quantor_add (Quantor *, int lit);
 
+/*------------------------------------------------------------------------*/
+/* Parse a complete QDIMACS instance of 'len' bytes from memory.  This is
+ * an alternative to 'quantor_scope' and 'quantor_add' and only allowed
+ * before any scope or clause has been added.  The result is zero if no
+ * error occured, otherwise it is a non zero error string including the
+ * line number, valid until the solver is deleted.  After an error the
+ * solver should only be deleted.
+ */
+const char * quantor_parse_buffer (Quantor *, const char *buffer, size_t len);
+
+/*------------------------------------------------------------------------*/
+/* Simplify the formula without calling a SAT solver: BCP, equivalence
+ * reasoning, subsumption and at most 'budget' eliminations of innermost
+ * existential variables which do not increase the number of literals.  A
+ * negative 'budget' means no limit.  Exported variables are never
+ * eliminated.  If the result is 'QUANTOR_RESULT_UNKNOWN' the remaining
+ * formula can be retrieved with 'quantor_scope_vars' and the clause
+ * iterator below, for instance to pass it on to another solver.  It may
+ * also be solved by calling 'quantor_sat' afterwards.  The result and the
+ * assignment of the exported variables then refer to the original
+ * formula.  Options are not changed.
+ */
+QuantorResult quantor_preprocess (Quantor *, int budget);
+
+/*------------------------------------------------------------------------*/
+/* Zero terminated list of the remaining variables of the 'i'-th non empty
+ * scope of the remaining formula, starting with the outermost scope at
+ * 'i = 0'.  The quantifier type of the scope is stored in '*type_ptr'.
+ * The result is zero if there is no such scope.  Otherwise it is valid
+ * until this function is called again.
+ */
+const int * quantor_scope_vars (Quantor *, int i,
+                                QuantorQuantificationType * type_ptr);
+
+/*------------------------------------------------------------------------*/
+/* Iterator over the literals of the remaining clauses.  Every clause is
+ * terminated by a zero literal.  'quantor_clause_it_next' stores the next
+ * literal in '*lit_ptr' and returns zero after the last clause.  The
+ * clauses should not be changed while the iterator is in use.
+ */
+typedef struct QuantorClauseIt QuantorClauseIt;
+
+QuantorClauseIt * quantor_clause_it_new (Quantor *);
+int quantor_clause_it_next (QuantorClauseIt *, int *lit_ptr);
+void quantor_clause_it_delete (QuantorClauseIt *);
+
+/*------------------------------------------------------------------------*/
+/* After 'quantor_preprocess' the remaining formula may be solved by
+ * another solver.  If it is true, pass the zero terminated list of
+ * literals assigning the variables of its outermost existential scope.
+ * The values of the exported variables removed during preprocessing are
+ * then derived and available through 'quantor_deref'.
+ */
+QuantorResult quantor_reconstruct (Quantor *, const int *assignment);
+
 /*------------------------------------------------------------------------*/
 /* Returns the assigned value of variable with index 'idx'.  The result is
  * '0' if the variables is assigned to false, '1' if it is assigned to true
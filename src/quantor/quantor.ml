@@ -31,6 +31,54 @@ type quantor
 
 type lit = Qbf.Lit.t
 
+type phase_stats = {
+  phase : string;
+  calls : int;
+  time : float;
+}
+
+type stats = {
+  exists : int;
+  foralls : int;
+  units : int;
+  unates : int;
+  bcps : int;
+  subsumed : int;
+  equivalences : int;
+  functions : int;
+  vars : int;
+  max_vars : int;
+  clauses : int;
+  max_clauses : int;
+  literals : int;
+  max_literals : int;
+  bytes : int;
+  max_bytes : int;
+  sat_solver_bytes : int;
+  footprint : int;
+  max_footprint : int;
+  max_rss : int;
+  seconds : float;
+  sat_solver_seconds : float;
+  phases : phase_stats list;
+}
+(* The field order must match [quantor_stub_stats] *)
+
+type progress = {
+  eliminations : int;
+  remaining_vars : int;
+  remaining_clauses : int;
+  remaining_literals : int;
+  allocated_bytes : int;
+  elapsed : float;
+}
+(* The field order must match [call_progress] in quantor_stubs.c *)
+
+type progress_action =
+  | Continue
+  | Stop_timeout
+  | Stop_spaceout
+
 external quantor_create : unit -> quantor = "quantor_stub_create"
 
 external quantor_delete : quantor -> unit = "quantor_stub_delete"
@@ -45,6 +93,23 @@ external quantor_add : quantor -> int -> unit = "quantor_stub_add"
 
 external quantor_deref : quantor -> int -> int = "quantor_stub_deref"
 
+external quantor_parse_string : quantor -> string -> unit
+  = "quantor_stub_parse_string"
+
+external quantor_stats : quantor -> stats = "quantor_stub_stats"
+
+external quantor_set_progress : quantor -> int -> (progress -> int) -> unit
+  = "quantor_stub_set_progress"
+
+external quantor_preprocess : quantor -> int -> int = "quantor_stub_preprocess"
+
+external quantor_prefix : quantor -> int array = "quantor_stub_prefix"
+
+external quantor_clauses : quantor -> int array = "quantor_stub_clauses"
+
+external quantor_reconstruct : quantor -> int array -> int
+  = "quantor_stub_reconstruct"
+
 (** {2 Direct Bindings} *)
 
 module Raw = struct
@@ -66,8 +131,7 @@ module Raw = struct
     | -1 -> Qbf.Undef
     | n -> failwith ("unknown quantor_deref result: " ^ string_of_int n)
 
-  let sat ((Quantor q) as solver) =
-    let i = quantor_sat q in
+  let result_of_int solver i =
     match i with
       | 0 -> Qbf.Unknown
       | 10 -> Qbf.Sat (fun i -> deref solver (Qbf.Lit.abs i))
@@ -76,6 +140,40 @@ module Raw = struct
       | 40 -> Qbf.Spaceout
       | _ -> failwith ("unknown quantor result: " ^string_of_int i)
 
+  let sat ((Quantor q) as solver) = result_of_int solver (quantor_sat q)
+
+  let preprocess ?(budget = -1) ((Quantor q) as solver) =
+    result_of_int solver (quantor_preprocess q budget)
+
+  (* split a flattened, zero terminated sequence *)
+  let rec _split a i acc =
+    if a.(i) = 0 then List.rev acc, i + 1
+    else _split a (i + 1) (Qbf.Lit.make a.(i) :: acc)
+
+  let prefix (Quantor q) =
+    let a = quantor_prefix q in
+    let rec scopes i =
+      if i >= Array.length a then []
+      else
+        let quant = if a.(i) = 1 then Qbf.Forall else Qbf.Exists in
+        let lits, i' = _split a (i + 1) [] in
+        if lits = [] then scopes i' else (quant, lits) :: scopes i'
+    in
+    scopes 0
+
+  let clauses (Quantor q) =
+    let a = quantor_clauses q in
+    let rec clauses i =
+      if i >= Array.length a then []
+      else
+        let c, i' = _split a i [] in
+        c :: clauses i'
+    in
+    clauses 0
+
+  let reconstruct (Quantor q) (lits : lit list) =
+    ignore (quantor_reconstruct q (Array.of_list (lits :> int list)))
+
   let scope (Quantor q) quant = match quant with
     | Qbf.Forall -> quantor_scope_forall q
     | Qbf.Exists -> quantor_scope_exists q
@@ -83,8 +181,24 @@ module Raw = struct
   let add_unsafe (Quantor q) i = quantor_add q i
 
   let add (Quantor q) i = quantor_add q (i:lit:>int)
+
+  let parse_string (Quantor q) s = quantor_parse_string q s
+
+  let stats (Quantor q) = quantor_stats q
+
+  let set_progress (Quantor q) ~every f =
+    quantor_set_progress q every
+      (fun p -> match f p with
+        | Continue -> 0
+        | Stop_timeout -> 30
+        | Stop_spaceout -> 40)
+
+  let clear_progress (Quantor q) =
+    quantor_set_progress q 0 (fun _ -> 0)
 end
 
+let stats = Raw.stats
+
 let rec _add_cnf solver cnf = match cnf with
   | Qbf.QCNF.Quant (quant, lits, cnf') ->
       Raw.scope solver quant;
@@ -98,9 +212,41 @@ let rec _add_cnf solver cnf = match cnf with
           Raw.add_unsafe solver 0;
         ) clauses
 
+let add_cnf = _add_cnf
+
 let solve cnf =
   let quantor = Raw.create () in
   _add_cnf quantor cnf;
   Raw.sat quantor
 
+type reconstruct = (lit -> Qbf.assignment) -> lit -> Qbf.assignment
+
+let preprocess ?budget cnf =
+  let quantor = Raw.create () in
+  _add_cnf quantor cnf;
+  let prefix, clauses = match Raw.preprocess ?budget quantor with
+    | Qbf.Unsat -> [], [[]]
+    | _ -> Raw.prefix quantor, Raw.clauses quantor
+  in
+  let cnf' =
+    List.fold_right
+      (fun (quant, lits) cnf' -> Qbf.QCNF.quantify quant lits cnf')
+      prefix (Qbf.QCNF.prop clauses)
+  in
+  let reconstruct model =
+    let outer = match prefix with
+      | (Qbf.Exists, lits) :: _ -> lits
+      | _ -> []
+    in
+    Raw.reconstruct quantor
+      (List.filter_map
+        (fun lit -> match model lit with
+          | Qbf.True -> Some lit
+          | Qbf.False -> Some (Qbf.Lit.neg lit)
+          | Qbf.Undef -> None)
+        outer);
+    fun lit -> Raw.deref quantor (Qbf.Lit.abs lit)
+  in
+  cnf', reconstruct
+
 let solver = {Qbf.solve=solve; Qbf.name="quantor";}
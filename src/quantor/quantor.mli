@@ -28,6 +28,65 @@ OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 
 type lit = Qbf.Lit.t
 
+(** Time spent in one phase of the solver ("parse", "bcp",
+    "forward_subsume", "exists", "forall", "sat", "lift" or "probe").
+    Time spent in a nested phase is only accounted for in the nested
+    phase. *)
+type phase_stats = {
+  phase : string;
+  calls : int;
+  time : float;  (** wall clock seconds *)
+}
+
+(** Statistics of a solver, see [quantor_get_stats] in [quantor.h].
+    Counters that depend on statistics code not compiled into the C
+    library are [0]. *)
+type stats = {
+  exists : int;  (** eliminated existential variables *)
+  foralls : int;  (** expanded universal variables *)
+  units : int;
+  unates : int;
+  bcps : int;
+  subsumed : int;  (** forward and backward subsumed clauses *)
+  equivalences : int;
+  functions : int;  (** extracted functions *)
+  vars : int;
+  max_vars : int;
+  clauses : int;
+  max_clauses : int;
+  literals : int;
+  max_literals : int;
+  bytes : int;  (** currently allocated by quantor *)
+  max_bytes : int;
+  sat_solver_bytes : int;  (** peak of the SAT solver calls *)
+  footprint : int;
+  (** [bytes] plus the memory of the SAT solver and an estimated malloc
+      overhead, checked against the space limit *)
+  max_footprint : int;
+  max_rss : int;  (** peak resident set size of the process, or [0] *)
+  seconds : float;  (** since the solver was created *)
+  sat_solver_seconds : float;
+  phases : phase_stats list;
+}
+
+(** Snapshot of the remaining formula, passed to a progress callback *)
+type progress = {
+  eliminations : int;  (** variables eliminated so far *)
+  remaining_vars : int;
+  remaining_clauses : int;
+  remaining_literals : int;
+  allocated_bytes : int;
+  elapsed : float;  (** seconds since the solver was created *)
+}
+
+(** Answer of a progress callback. [Stop_timeout] and [Stop_spaceout]
+    abort {!Raw.sat}, which then returns [Qbf.Timeout] resp.
+    [Qbf.Spaceout]. *)
+type progress_action =
+  | Continue
+  | Stop_timeout
+  | Stop_spaceout
+
 (** {2 Direct Bindings} *)
 
 module Raw : sig
@@ -46,10 +105,56 @@ module Raw : sig
   val add : t -> lit -> unit
   (** Add a literal, or end the current clause/scope with [0] *)
 
+  val parse_string : t -> string -> unit
+  (** Load a complete problem in QDIMACS format. Much faster than
+      {!add} for large problems. Only allowed before anything else was
+      added to the solver.
+      @raise Failure with the line number if the input is malformed *)
+
   val deref : t -> lit -> Qbf.assignment
   (** Obtain the value of this literal in the current model *)
+
+  val stats : t -> stats
+  (** Snapshot of the statistics collected so far *)
+
+  val set_progress : t -> every:int -> (progress -> progress_action) -> unit
+  (** [set_progress s ~every f] calls [f] every [every] variable
+      eliminations during {!sat}, e.g. to display progress or to give up
+      early when the formula grows too fast. It replaces the previous
+      callback; [every <= 0] removes it. An exception raised by [f] aborts
+      the solver as [Stop_timeout] would. *)
+
+  val clear_progress : t -> unit
+  (** Remove the progress callback *)
+
+  val preprocess : ?budget:int -> t -> Qbf.result
+  (** Simplify the formula without calling a SAT solver, eliminating at
+      most [budget] (default: no limit) existential variables whose
+      elimination does not add literals, see [quantor_preprocess].
+      Returns [Qbf.Unknown] if the formula was not solved, in which case
+      {!prefix} and {!clauses} give the remaining formula.  It can also be
+      solved with {!sat} afterwards. *)
+
+  val prefix : t -> (Qbf.quantifier * lit list) list
+  (** Remaining quantifier prefix, outermost scope first *)
+
+  val clauses : t -> Qbf.CNF.t
+  (** Remaining clauses *)
+
+  val reconstruct : t -> lit list -> unit
+  (** [reconstruct s lits] derives the values of all variables of the
+      outermost scope of the original formula from the values [lits] of
+      the outermost existential variables of the remaining formula, which
+      must be true. Use {!deref} afterwards. *)
 end
 
+val stats : Raw.t -> stats
+(** Same as {!Raw.stats} *)
+
+val add_cnf : Raw.t -> Qbf.QCNF.t -> unit
+(** Add the quantifier prefix and the clauses of a QCNF to the solver,
+    e.g. to inspect {!stats} after calling {!Raw.sat} *)
+
 (** {2 Solver}
 
 {[
@@ -60,4 +165,15 @@ end
 
 val solve : Qbf.QCNF.t -> Qbf.result
 
+type reconstruct = (lit -> Qbf.assignment) -> lit -> Qbf.assignment
+(** Maps a model of the outermost existential variables of a preprocessed
+    formula to a model of the outermost variables of the original one *)
+
+val preprocess : ?budget:int -> Qbf.QCNF.t -> Qbf.QCNF.t * reconstruct
+(** [preprocess cnf] uses Quantor's BCP, equivalence reasoning,
+    subsumption and cheap variable eliminations to simplify [cnf] into an
+    equivalent formula for another solver. If that formula is true, pass
+    its model to the second component to obtain a model of [cnf].
+    See {!Raw.preprocess} for [budget]. *)
+
 val solver : Qbf.solver
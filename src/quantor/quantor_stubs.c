@@ -28,8 +28,47 @@ OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 #include <caml/memory.h>
 #include <caml/alloc.h>
 #include "caml/fail.h"
+#include <caml/callback.h>
+#include <stdlib.h>
 #include "quantor.h"
 
+/* The OCaml progress closure, registered as a global root for as long as
+   it is installed in the solver. */
+static void release_progress(void *state)
+{
+  value *closure = (value*) state;
+
+  if (closure != NULL)
+  {
+    caml_remove_generational_global_root(closure);
+    free(closure);
+  }
+}
+
+static QuantorResult call_progress(void *state, const QuantorProgress *p)
+{
+  CAMLparam0();
+  CAMLlocal2(rec, res);
+  value *closure = (value*) state;
+
+  /* must match the field order of [Quantor.progress] */
+  rec = caml_alloc_tuple(6);
+  Store_field(rec, 0, Val_long(p->eliminations));
+  Store_field(rec, 1, Val_long(p->vars));
+  Store_field(rec, 2, Val_long(p->clauses));
+  Store_field(rec, 3, Val_long(p->literals));
+  Store_field(rec, 4, Val_long(p->bytes));
+  Store_field(rec, 5, caml_copy_double(p->seconds));
+
+  res = caml_callback_exn(*closure, rec);
+
+  /* an exception escaping the closure aborts the solver */
+  if (Is_exception_result(res))
+    CAMLreturnT(QuantorResult, QUANTOR_RESULT_TIMEOUT);
+
+  CAMLreturnT(QuantorResult, (QuantorResult) Int_val(res));
+}
+
 CAMLprim value quantor_stub_create(value unit)
 {
   CAMLparam0();
@@ -41,6 +80,7 @@ CAMLprim value quantor_stub_delete(value raw)
 {
   CAMLparam0();
   Quantor* q = (Quantor*) raw;
+  release_progress(quantor_set_progress(q, 0, NULL, NULL));
   quantor_delete(q);
   CAMLreturn (Val_unit);
 }
@@ -99,6 +139,23 @@ CAMLprim value quantor_stub_add(value raw, value i)
   CAMLreturn (Val_unit);
 }
 
+CAMLprim value quantor_stub_parse_string(value raw, value s)
+{
+  CAMLparam1(s);
+  Quantor* q = (Quantor*) raw;
+
+  /* the parser does not allocate on the OCaml heap, so [s] stays put */
+  const char* err =
+    quantor_parse_buffer(q, String_val(s), caml_string_length(s));
+
+  if (err != 0)
+  {
+    caml_failwith(err);
+  }
+
+  CAMLreturn (Val_unit);
+}
+
 CAMLprim value quantor_stub_deref(value raw, value i)
 {
   CAMLparam0();
@@ -109,3 +166,172 @@ CAMLprim value quantor_stub_deref(value raw, value i)
 
   CAMLreturn (Val_int(res));
 }
+
+CAMLprim value quantor_stub_set_progress(value raw, value every, value f)
+{
+  CAMLparam1(f);
+  Quantor* q = (Quantor*) raw;
+  int interval = Int_val(every);
+  value *closure = NULL;
+  void *old;
+
+  if (interval > 0)
+  {
+    closure = (value*) malloc(sizeof(value));
+    if (closure == NULL)
+    {
+      caml_raise_out_of_memory();
+    }
+    *closure = f;
+    caml_register_generational_global_root(closure);
+    old = quantor_set_progress(q, interval, call_progress, closure);
+  }
+  else
+  {
+    old = quantor_set_progress(q, 0, NULL, NULL);
+  }
+
+  release_progress(old);
+
+  CAMLreturn (Val_unit);
+}
+
+CAMLprim value quantor_stub_stats(value raw)
+{
+  CAMLparam0();
+  CAMLlocal4(res, phases, phase, cell);
+  Quantor* q = (Quantor*) raw;
+  QuantorStats s;
+  int i;
+
+  quantor_get_stats(q, &s);
+
+  phases = Val_emptylist;
+  for (i = QUANTOR_NUM_PHASES - 1; i >= 0; i--)
+  {
+    /* must match the field order of [Quantor.phase_stats] */
+    phase = caml_alloc_tuple(3);
+    Store_field(phase, 0, caml_copy_string(quantor_phase_name(i)));
+    Store_field(phase, 1, Val_long((long) s.phase_count[i]));
+    Store_field(phase, 2, caml_copy_double(s.phase_seconds[i]));
+
+    cell = caml_alloc_tuple(2);
+    Store_field(cell, 0, phase);
+    Store_field(cell, 1, phases);
+    phases = cell;
+  }
+
+  /* must match the field order of [Quantor.stats] */
+  res = caml_alloc_tuple(23);
+  Store_field(res, 0, Val_long((long) s.exists));
+  Store_field(res, 1, Val_long((long) s.foralls));
+  Store_field(res, 2, Val_long((long) s.units));
+  Store_field(res, 3, Val_long((long) s.unates));
+  Store_field(res, 4, Val_long((long) s.bcps));
+  Store_field(res, 5, Val_long((long) s.subsumed));
+  Store_field(res, 6, Val_long((long) s.equivalences));
+  Store_field(res, 7, Val_long((long) s.functions));
+  Store_field(res, 8, Val_long(s.vars));
+  Store_field(res, 9, Val_long(s.max_vars));
+  Store_field(res, 10, Val_long(s.clauses));
+  Store_field(res, 11, Val_long(s.max_clauses));
+  Store_field(res, 12, Val_long(s.literals));
+  Store_field(res, 13, Val_long(s.max_literals));
+  Store_field(res, 14, Val_long(s.bytes));
+  Store_field(res, 15, Val_long(s.max_bytes));
+  Store_field(res, 16, Val_long(s.sat_solver_bytes));
+  Store_field(res, 17, Val_long(s.footprint));
+  Store_field(res, 18, Val_long(s.max_footprint));
+  Store_field(res, 19, Val_long(s.max_rss));
+  Store_field(res, 20, caml_copy_double(s.seconds));
+  Store_field(res, 21, caml_copy_double(s.sat_solver_seconds));
+  Store_field(res, 22, phases);
+
+  CAMLreturn (res);
+}
+
+CAMLprim value quantor_stub_preprocess(value raw, value budget)
+{
+  CAMLparam0();
+  Quantor* q = (Quantor*) raw;
+  int c = quantor_preprocess(q, Int_val(budget));
+  CAMLreturn (Val_int(c));
+}
+
+/* The remaining prefix, flattened: for each scope its quantifier
+   ([0] for exists, [1] for forall) followed by its variables and [0]. */
+CAMLprim value quantor_stub_prefix(value raw)
+{
+  CAMLparam0();
+  CAMLlocal1(res);
+  Quantor* q = (Quantor*) raw;
+  QuantorQuantificationType type;
+  const int *vars;
+  int i, n;
+
+  n = 0;
+  for (i = 0; (vars = quantor_scope_vars(q, i, &type)) != NULL; i++)
+  {
+    for (n += 2; *vars; vars++)
+      n++;
+  }
+
+  res = caml_alloc(n, 0);
+  n = 0;
+  for (i = 0; (vars = quantor_scope_vars(q, i, &type)) != NULL; i++)
+  {
+    Store_field(res, n++, Val_int(type == QUANTOR_UNIVERSAL_VARIABLE_TYPE));
+    for (; *vars; vars++)
+      Store_field(res, n++, Val_int(*vars));
+    Store_field(res, n++, Val_int(0));
+  }
+
+  CAMLreturn (res);
+}
+
+/* The remaining clauses, flattened, each one terminated by [0]. */
+CAMLprim value quantor_stub_clauses(value raw)
+{
+  CAMLparam0();
+  CAMLlocal1(res);
+  Quantor* q = (Quantor*) raw;
+  QuantorClauseIt *it;
+  int lit, n;
+
+  n = 0;
+  it = quantor_clause_it_new(q);
+  while (quantor_clause_it_next(it, &lit))
+    n++;
+  quantor_clause_it_delete(it);
+
+  res = caml_alloc(n, 0);
+  n = 0;
+  it = quantor_clause_it_new(q);
+  while (quantor_clause_it_next(it, &lit))
+    Store_field(res, n++, Val_int(lit));
+  quantor_clause_it_delete(it);
+
+  CAMLreturn (res);
+}
+
+CAMLprim value quantor_stub_reconstruct(value raw, value lits)
+{
+  CAMLparam1(lits);
+  Quantor* q = (Quantor*) raw;
+  mlsize_t i, n = Wosize_val(lits);
+  int *assignment;
+  int c;
+
+  assignment = (int*) malloc((n + 1) * sizeof(int));
+  if (assignment == NULL)
+  {
+    caml_raise_out_of_memory();
+  }
+  for (i = 0; i < n; i++)
+    assignment[i] = Int_val(Field(lits, i));
+  assignment[n] = 0;
+
+  c = quantor_reconstruct(q, assignment);
+  free(assignment);
+  CAMLreturn (Val_int(c));
+}
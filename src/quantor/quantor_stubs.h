@@ -33,3 +33,10 @@ CAMLprim value quantor_stub_exists(value q);
 CAMLprim value quantor_stub_forall(value q);
 CAMLprim value quantor_stub_add(value q, value i);
 CAMLprim value quantor_stub_deref(value q, value i);
+CAMLprim value quantor_stub_parse_string(value q, value s);
+CAMLprim value quantor_stub_stats(value q);
+CAMLprim value quantor_stub_set_progress(value q, value every, value f);
+CAMLprim value quantor_stub_preprocess(value q, value budget);
+CAMLprim value quantor_stub_prefix(value q);
+CAMLprim value quantor_stub_clauses(value q);
+CAMLprim value quantor_stub_reconstruct(value q, value lits);
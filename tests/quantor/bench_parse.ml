@@ -0,0 +1,60 @@
+(* Benchmark of loading large random problems into Quantor, either
+   through [Quantor.Raw.parse_string] or literal by literal through
+   [Quantor.add_cnf].
+
+   Usage: bench_parse.exe [vars [clauses]]
+   or: dune build @tests/quantor/bench *)
+
+open Qbf
+
+let vars = try int_of_string Sys.argv.(1) with _ -> 100_000
+let clauses = try int_of_string Sys.argv.(2) with _ -> 1_000_000
+let universals = vars / 100
+
+let () = Random.init 42
+
+let problem =
+  let lit () =
+    let v = 1 + Random.int vars in
+    Lit.make (if Random.bool () then v else -v)
+  in
+  let rec range i j = if i > j then [] else Lit.make i :: range (i+1) j in
+  let cnf = Array.to_list (Array.init clauses (fun _ -> [lit (); lit (); lit ()])) in
+  QCNF.forall (range 1 universals)
+    (QCNF.exists (range (universals+1) vars) (QCNF.prop cnf))
+
+let qdimacs =
+  let buf = Buffer.create (16 * clauses) in
+  let add_lits prefix lits =
+    Buffer.add_string buf prefix;
+    List.iter
+      (fun l -> Buffer.add_string buf (string_of_int (Lit.to_int l));
+        Buffer.add_char buf ' ')
+      lits;
+    Buffer.add_string buf "0\n"
+  in
+  Printf.bprintf buf "p cnf %d %d\n" vars clauses;
+  let rec aux = function
+    | QCNF.Quant (Forall, lits, f) -> add_lits "a " lits; aux f
+    | QCNF.Quant (Exists, lits, f) -> add_lits "e " lits; aux f
+    | QCNF.Prop cnf -> List.iter (add_lits "") cnf
+  in
+  aux problem;
+  Buffer.contents buf
+
+let time name f =
+  let start = Sys.time () in
+  let q = Quantor.Raw.create () in
+  f q;
+  let seconds = Sys.time () -. start in
+  let parse =
+    List.find (fun p -> p.Quantor.phase = "parse") (Quantor.stats q).Quantor.phases
+  in
+  Printf.printf "%-14s %8.2f seconds (%.2f in the parser)\n%!"
+    name seconds parse.Quantor.time
+
+let () =
+  Printf.printf "%d variables, %d clauses, %.1f MB of QDIMACS\n%!"
+    vars clauses (float_of_int (String.length qdimacs) /. 1048576.);
+  time "parse_string" (fun q -> Quantor.Raw.parse_string q qdimacs);
+  time "add_cnf" (fun q -> Quantor.add_cnf q problem)
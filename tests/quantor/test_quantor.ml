@@ -21,9 +21,146 @@ let test_quantor_true _ =
     let _ = solve ~solver:Quantor.solver qcnf
     in ()
 
+let test_quantor_stats _ =
+    let a,b,c = (Lit.make 1, Lit.make 2, Lit.make 3) in
+    let formula = and_l [or_l [atom a; atom b]; or_l [atom b; atom c]] in
+    let qcnf = QFormula.cnf (forall [a] (exists [b; c] (prop formula))) in
+    let q = Quantor.Raw.create () in
+    Quantor.add_cnf q qcnf;
+    let _ = Quantor.Raw.sat q in
+    let s = Quantor.stats q in
+    assert_bool "max_bytes" (s.Quantor.max_bytes > 0);
+    assert_bool "bytes" (s.Quantor.bytes <= s.Quantor.max_bytes);
+    assert_bool "footprint"
+      (s.Quantor.max_bytes <= s.Quantor.max_footprint);
+    assert_bool "seconds" (s.Quantor.seconds >= 0.);
+    let bcp = List.find (fun p -> p.Quantor.phase = "bcp") s.Quantor.phases in
+    assert_bool "bcp calls" (bcp.Quantor.calls > 0)
+
+(* No literal is pure and no clause is blocked, so at least one variable
+   has to be eliminated before the formula is solved. *)
+let test_quantor_progress _ =
+    let lits = List.map Lit.make in
+    let qcnf =
+      QCNF.forall (lits [1; 2]) (QCNF.exists (lits [3; 4; 5])
+        (QCNF.prop
+          (List.map lits [[-3; 2; -1]; [5; -1; 2]; [-4; 1; -2]; [4; 3; -5]])))
+    in
+    let q = Quantor.Raw.create () in
+    Quantor.add_cnf q qcnf;
+    let calls = ref 0 in
+    Quantor.Raw.set_progress q ~every:1
+      (fun p ->
+        incr calls;
+        assert_bool "eliminations" (p.Quantor.eliminations > 0);
+        Quantor.Stop_spaceout);
+    (match Quantor.Raw.sat q with
+     | Spaceout -> ()
+     | _ -> assert_failure "expected spaceout");
+    assert_equal 1 !calls
+
+let test_quantor_parse_string _ =
+    let q = Quantor.Raw.create () in
+    Quantor.Raw.parse_string q
+      "c comment\np cnf 3 2\na 1 0\ne 2 3 0\n1 2 0\n-1 3 0\n";
+    (match Quantor.Raw.sat q with
+     | Sat _ -> ()
+     | _ -> assert_failure "expected sat");
+    let q = Quantor.Raw.create () in
+    assert_raises (Failure "line 2: invalid character")
+      (fun () -> Quantor.Raw.parse_string q "p cnf 1 1\n1 x 0\n")
+
+(* Variables 3 and 5 are pure and removed by preprocessing.  The
+   reconstructed values of the outermost variables 1, 3 and 4 have to
+   extend to a model of the original formula. *)
+let test_quantor_preprocess _ =
+    let a,b,c,d,e,f = (Lit.make 1, Lit.make 2, Lit.make 3,
+                       Lit.make 4, Lit.make 5, Lit.make 6) in
+    let quantify cnf =
+      QCNF.exists [a; c; d] (QCNF.forall [b] (QCNF.exists [e; f]
+        (QCNF.prop cnf))) in
+    let cnf = List.map (List.map Lit.make)
+      [[-2; 6; 1]; [-1; 4; -6]; [-6; 2]; [-4; -5]; [-4; 6]; [-1; -4; -3]] in
+    let order l = List.sort Stdlib.compare l in
+    let rec sort = function
+      | QCNF.Quant (q, lits, f') -> QCNF.Quant (q, order lits, sort f')
+      | QCNF.Prop cnf -> QCNF.Prop (order (List.map order cnf))
+    in
+    let qcnf', reconstruct = Quantor.preprocess (quantify cnf) in
+    let expected =
+      QCNF.exists [a; d] (QCNF.forall [b] (QCNF.exists [f]
+        (QCNF.prop (List.map (List.map Lit.make)
+          [[1; -2; 6]; [-1; 4; -6]; [2; -6]; [-4; 6]])))) in
+    assert_equal (sort expected) (sort qcnf');
+    match Quantor.solve qcnf' with
+    | Sat model ->
+        let model = reconstruct model in
+        assert_equal Qbf.False (model c);
+        let units =
+          List.map
+            (fun l -> match model l with
+              | Qbf.True -> [l]
+              | Qbf.False -> [Lit.neg l]
+              | Qbf.Undef -> assert_failure "unassigned")
+            [a; c; d] in
+        (match Quantor.solve (quantify (units @ cnf)) with
+         | Sat _ -> ()
+         | _ -> assert_failure "model does not extend")
+    | _ -> assert_failure "expected sat"
+
+(* Solving after preprocessing continues with the remaining formula. *)
+let test_quantor_preprocess_sat _ =
+    let lits = List.map Lit.make in
+    let cnf = List.map lits
+      [[-2; 6; 1]; [-1; 4; -6]; [-6; 2]; [-4; -5]; [-4; 6]; [-1; -4; -3]] in
+    let q = Quantor.Raw.create () in
+    Quantor.add_cnf q
+      (QCNF.exists (lits [1; 3; 4]) (QCNF.forall (lits [2])
+        (QCNF.exists (lits [5; 6]) (QCNF.prop cnf))));
+    (match Quantor.Raw.preprocess q with
+     | Unknown -> ()
+     | _ -> assert_failure "expected unknown");
+    match Quantor.Raw.sat q with
+    | Sat _ -> ()
+    | _ -> assert_failure "expected sat"
+
+let assert_model lits cnf =
+    let cnf = List.map (List.map Lit.make) cnf in
+    let lits = List.map Lit.make lits in
+    match Quantor.solve (QCNF.exists lits (QCNF.prop cnf)) with
+    | Sat model ->
+        List.iter
+          (fun c ->
+            assert_bool "clause"
+              (List.exists (fun l -> (model l = Qbf.True) = Lit.sign l) c))
+          cnf
+    | _ -> assert_failure "expected sat"
+
+(* Variable 3 is substituted by -1 before blocked clause elimination. *)
+let test_quantor_blocked_model _ =
+    assert_model [7;5;4;1;6;2;3;9;8]
+      [[5;9;-3]; [4]; [-2;-8]; [-9;-5]; [2;-4;-3]; [-1;8;4]; [2;1]; [5;-6];
+       [6;3;-5]; [-1;-3]; [-8;2;-6]; [-3;9]; [-5;6;-3]; [2;1;-4]; [4;-8];
+       [7;-1]; [-1;-7;9]; [9;4]; [-3;-6]; [-4;3;1]]
+
+(* The equivalence of 2 and -1 is only found after blocked clause
+   elimination. *)
+let test_quantor_blocked_model_late _ =
+    assert_model [4;2;7;8;6;5;1;3]
+      [[-7;1]; [-1;-4;-8]; [-8;-1;7]; [3;-8;-2]; [-5;-8;-2]; [-4;1;-7];
+       [-4;-5;3]; [4]; [-3;-5;8]; [-3;5;7]; [3;-5;-8]; [3;5;-7]; [-4;7;2];
+       [-4;-7;-2]; [4;-7;2]; [4;7;-2]; [-8;3;1]; [-8;-3;-1]; [8;-3;1];
+       [8;3;-1]]
 
 let () = run_test_tt_main (
 "quantor">:::[
     "test_quantor_false">::(test_quantor_false);
     "test_quantor_true">::(test_quantor_true);
+    "test_quantor_stats">::(test_quantor_stats);
+    "test_quantor_progress">::(test_quantor_progress);
+    "test_quantor_parse_string">::(test_quantor_parse_string);
+    "test_quantor_preprocess">::(test_quantor_preprocess);
+    "test_quantor_preprocess_sat">::(test_quantor_preprocess_sat);
+    "test_quantor_blocked_model">::(test_quantor_blocked_model);
+    "test_quantor_blocked_model_late">::(test_quantor_blocked_model_late);
 ])